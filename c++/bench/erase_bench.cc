@@ -0,0 +1,105 @@
+#include "benchmark/benchmark.h"
+#include "benchset/myflat.hh"
+#include "workload.hh"
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+#include <boost/container/flat_set.hpp>
+
+// Erases n / 2 keys, half of them present, from a set of n keys from
+// [0, 2n) of the distribution of the second argument, which the erased keys
+// follow too, as workload::queries. The set is refilled, without timing,
+// before each round of erases: it lives across rounds so that what is left
+// of it is not freed within the timing either.
+template<typename Set>
+static auto erase_keys(Set& xs, std::vector<int> const& ks) -> void {
+  for (auto k : ks) xs.erase(k);
+}
+
+// my::flat_set given the keys at once: they are sorted, then removed in
+// one pass over the set.
+struct flat_set_batched : my::flat_set<int> {
+  using my::flat_set<int>::flat_set;
+};
+
+static auto erase_keys(flat_set_batched& xs, std::vector<int> const& ks) -> void {
+  auto sorted = ks;
+  std::sort(sorted.begin(), sorted.end());
+  xs.erase_sorted(sorted.begin(), sorted.end());
+}
+
+static auto erase_input(benchmark::State const& state) -> std::vector<int> {
+  auto const n = int(state.range(0));
+  auto rng = std::mt19937_64(n);
+  return workload::keys(rng, workload::dist(state.range(1)), n, 2 * int64_t{n});
+}
+
+static void erase_args(benchmark::internal::Benchmark* b, int up_to) {
+  for (auto d : workload::dists)
+    for (auto n = 1000; n <= up_to; n *= 10)
+      b->Args({n, int(d)});
+}
+
+static void erase_args(benchmark::internal::Benchmark* b) { erase_args(b, 100000); }
+static void small_erase_args(benchmark::internal::Benchmark* b) { erase_args(b, 10000); }
+
+template<typename Set>
+static void BM_EraseHalf(benchmark::State& state) {
+  auto const n = state.range(0);
+  auto const d = workload::dist(state.range(1));
+  auto const keys = erase_input(state);
+  auto sorted = keys;
+  std::sort(sorted.begin(), sorted.end());
+  auto rng = std::mt19937_64(n + 1);
+  auto const erased = workload::queries(rng, d, sorted, n / 2);
+
+  auto const full = Set(keys.begin(), keys.end());
+  auto xs = Set{};
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    xs = full;
+    state.ResumeTiming();
+    erase_keys(xs, erased);
+    benchmark::DoNotOptimize(xs.size());
+  }
+  state.SetItemsProcessed(state.iterations() * (n / 2));
+  state.SetLabel(workload::name(d));
+}
+BENCHMARK_TEMPLATE(BM_EraseHalf, std::set<int>)->Apply(erase_args);
+BENCHMARK_TEMPLATE(BM_EraseHalf, boost::container::flat_set<int>)->Apply(erase_args);
+BENCHMARK_TEMPLATE(BM_EraseHalf, my::flat_set<int>)->Apply(erase_args);
+BENCHMARK_TEMPLATE(BM_EraseHalf, flat_set_batched)->Apply(erase_args);
+
+// Erases the keys satisfying a predicate, the multiples of 3, from a set of
+// n keys as above: one pass for the flat sets.
+template<typename Set>
+static auto erase_multiples_of_3(Set& xs) -> void {
+  for (auto it = xs.begin(); it != xs.end();)
+    it = *it % 3 == 0? xs.erase(it) : std::next(it);
+}
+
+static auto erase_multiples_of_3(my::flat_set<int>& xs) -> void {
+  xs.erase_if([](int k) { return k % 3 == 0; });
+}
+
+template<typename Set>
+static void BM_EraseIf(benchmark::State& state) {
+  auto const n = state.range(0);
+  auto const keys = erase_input(state);
+
+  auto const full = Set(keys.begin(), keys.end());
+  auto xs = Set{};
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    xs = full;
+    state.ResumeTiming();
+    erase_multiples_of_3(xs);
+    benchmark::DoNotOptimize(xs.size());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetLabel(workload::name(workload::dist(state.range(1))));
+}
+BENCHMARK_TEMPLATE(BM_EraseIf, std::set<int>)->Apply(erase_args);
+BENCHMARK_TEMPLATE(BM_EraseIf, boost::container::flat_set<int>)->Apply(small_erase_args);
+BENCHMARK_TEMPLATE(BM_EraseIf, my::flat_set<int>)->Apply(erase_args);
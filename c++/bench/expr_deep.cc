@@ -0,0 +1,122 @@
+#include "benchmark/benchmark.h"
+#include "expr/va_iter.hh"
+#include "expr/bt_iter.hh"
+
+// The chain expressions of expr_matrix.cc, but deep enough to overflow
+// the stack of the recursive visitors (and of the recursive destructors).
+
+static auto deep_va(int64_t depth) -> va::expr {
+  va::expr e0 = (va::expr{1} + va::expr{0} * va::expr{"x"}) * va::expr{3} + va::expr{12};
+  for (auto j = 0; j < depth; ++j) {
+    if (j % 2)
+      e0 = e0 / va::expr{2};
+    else
+      e0 = va::expr{3} * e0 + va::expr{1};
+  }
+  return e0;
+}
+
+// Same as deep_va, but e0 is moved into the new nodes: copying it would copy
+// the whole tree at every step.
+static auto deep_bt(int64_t depth) -> bt::expr {
+  bt::expr e0 = (bt::expr{1} + bt::expr{0} * bt::expr{"x"}) * bt::expr{3} + bt::expr{12};
+  for (auto j = 0; j < depth; ++j) {
+    if (j % 2)
+      e0 = std::move(e0) / bt::expr{2};
+    else
+      e0 = bt::expr{3} * std::move(e0) + bt::expr{1};
+  }
+  return e0;
+}
+
+static void BM_Std17Expr_DeepSimplify(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    auto e0 = deep_va(state.range(0));
+    state.ResumeTiming();
+    auto s0 = va::iter::simplify(e0);
+    state.PauseTiming();
+    va::iter::destroy(s0);
+    va::iter::destroy(e0);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_Std17Expr_DeepSimplify)
+    ->Args({1000})
+    ->Args({100000})
+    ->Args({1000000});
+
+static void BM_Std17Expr_DeepSize(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    auto e0 = deep_va(state.range(0));
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(va::iter::size(e0));
+    state.PauseTiming();
+    va::iter::destroy(e0);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_Std17Expr_DeepSize)
+    ->Args({1000})
+    ->Args({100000})
+    ->Args({1000000});
+
+static void BM_Std17Expr_DeepDestroy(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    auto e0 = deep_va(state.range(0));
+    state.ResumeTiming();
+    va::iter::destroy(e0);
+  }
+}
+BENCHMARK(BM_Std17Expr_DeepDestroy)
+    ->Args({1000})
+    ->Args({100000})
+    ->Args({1000000});
+
+static void BM_BoostExpr_DeepSimplify(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    auto e0 = deep_bt(state.range(0));
+    state.ResumeTiming();
+    auto s0 = bt::iter::simplify(e0);
+    state.PauseTiming();
+    bt::iter::destroy(s0);
+    bt::iter::destroy(e0);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_BoostExpr_DeepSimplify)
+    ->Args({1000})
+    ->Args({100000})
+    ->Args({1000000});
+
+static void BM_BoostExpr_DeepSize(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    auto e0 = deep_bt(state.range(0));
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(bt::iter::size(e0));
+    state.PauseTiming();
+    bt::iter::destroy(e0);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_BoostExpr_DeepSize)
+    ->Args({1000})
+    ->Args({100000})
+    ->Args({1000000});
+
+static void BM_BoostExpr_DeepDestroy(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    auto e0 = deep_bt(state.range(0));
+    state.ResumeTiming();
+    bt::iter::destroy(e0);
+  }
+}
+BENCHMARK(BM_BoostExpr_DeepDestroy)
+    ->Args({1000})
+    ->Args({100000})
+    ->Args({1000000});
@@ -0,0 +1,105 @@
+#include "benchmark/benchmark.h"
+#include "expr/va_io.hh"
+#include "expr/va_iter.hh"
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+// Unlike the chains of expr_matrix.cc, which simplify to a constant, this one
+// keeps a variable so the simplified expression is as large as the input.
+static auto unsimplified(int64_t depth) -> va::expr {
+  va::expr e0 = (va::expr{1} + va::expr{0} * va::expr{"x"}) * va::expr{"y"} + va::expr{12};
+  for (auto j = 0; j < depth; ++j) {
+    if (j % 2)
+      e0 = e0 / va::expr{2};
+    else
+      e0 = va::expr{3} * e0 + (va::expr{1} - va::expr{1});
+  }
+  return e0;
+}
+
+static auto simplified(int64_t depth) -> va::expr {
+  auto e0 = unsimplified(depth);
+  auto s0 = va::iter::simplify(e0);
+  va::iter::destroy(e0);
+  return s0;
+}
+
+static void BM_Std17Expr_BuildAndSimplify(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    auto s0 = simplified(state.range(0));
+    state.PauseTiming();
+    va::iter::destroy(s0);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_Std17Expr_BuildAndSimplify)
+    ->Args({1000})
+    ->Args({100000});
+
+static void BM_Std17Expr_Serialize(benchmark::State& state) {
+  auto s0 = simplified(state.range(0));
+  auto bytes = std::vector<uint8_t>{};
+  while (state.KeepRunning()) {
+    bytes.clear();
+    va::io::write(s0, bytes);
+  }
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+  va::iter::destroy(s0);
+}
+BENCHMARK(BM_Std17Expr_Serialize)
+    ->Args({1000})
+    ->Args({100000});
+
+static void BM_Std17Expr_Deserialize(benchmark::State& state) {
+  auto s0 = simplified(state.range(0));
+  auto const bytes = va::io::write(s0);
+  va::iter::destroy(s0);
+  while (state.KeepRunning()) {
+    auto e = va::io::read(bytes);
+    state.PauseTiming();
+    va::iter::destroy(e);
+    state.ResumeTiming();
+  }
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+BENCHMARK(BM_Std17Expr_Deserialize)
+    ->Args({1000})
+    ->Args({100000});
+
+static void BM_Std17Expr_LoadMapped(benchmark::State& state) {
+  auto const path = (std::filesystem::temp_directory_path() /
+                     ("va_io_bench_" + std::to_string(state.range(0)) + ".bin")).string();
+  auto s0 = simplified(state.range(0));
+  va::io::save(path, s0);
+  va::iter::destroy(s0);
+  while (state.KeepRunning()) {
+    auto e = va::io::load(path);
+    state.PauseTiming();
+    va::iter::destroy(e);
+    state.ResumeTiming();
+  }
+  std::remove(path.c_str());
+}
+BENCHMARK(BM_Std17Expr_LoadMapped)
+    ->Args({1000})
+    ->Args({100000});
+
+// A DAG with 2^depth paths but only depth nodes: back-references keep the
+// encoding linear in the number of distinct nodes.
+static void BM_Std17Expr_SerializeShared(benchmark::State& state) {
+  auto e0 = va::expr{"x"};
+  for (auto j = 0; j < state.range(0); ++j)
+    e0 = e0 * e0 + va::expr{j};
+  auto bytes = std::vector<uint8_t>{};
+  while (state.KeepRunning()) {
+    bytes.clear();
+    va::io::write(e0, bytes);
+  }
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+  state.SetLabel("bytes: " + std::to_string(bytes.size()));
+  va::iter::destroy(e0);
+}
+BENCHMARK(BM_Std17Expr_SerializeShared)
+    ->Args({64})
+    ->Args({4096});
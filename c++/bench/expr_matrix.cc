@@ -0,0 +1,204 @@
+#include "benchmark/benchmark.h"
+#include "expr/va_iter.hh"
+#include "expr/bt_iter.hh"
+#include "expr/tg.hh"
+#include <random>
+#include <type_traits>
+#include <utility>
+
+// Every expression representation against every workload: the benchmarks
+// are templates over a backend (how to build, simplify, copy and free an
+// expression) and a workload (which expression to build).
+
+struct std17_backend {
+  using expr = va::expr;
+
+  auto num(int64_t n) -> expr { return expr{n}; }
+  auto var(char const* name) -> expr { return expr{std::string(name)}; }
+
+  template<typename L, typename R>
+  auto add(L&& lhs, R&& rhs) -> expr { return std::forward<L>(lhs) + std::forward<R>(rhs); }
+
+  template<typename L, typename R>
+  auto mul(L&& lhs, R&& rhs) -> expr { return std::forward<L>(lhs) * std::forward<R>(rhs); }
+
+  template<typename L, typename R>
+  auto div(L&& lhs, R&& rhs) -> expr { return std::forward<L>(lhs) / std::forward<R>(rhs); }
+
+  auto simplify(expr const& e) -> expr { return va::iter::simplify(e); }
+  auto copy(expr const& e) -> expr { return e; }
+  auto release(expr& e) -> void { va::iter::destroy(e); }
+};
+
+struct boost_backend {
+  using expr = bt::expr;
+
+  auto num(int64_t n) -> expr { return expr{n}; }
+  auto var(char const* name) -> expr { return expr{std::string(name)}; }
+
+  template<typename L, typename R>
+  auto add(L&& lhs, R&& rhs) -> expr { return std::forward<L>(lhs) + std::forward<R>(rhs); }
+
+  template<typename L, typename R>
+  auto mul(L&& lhs, R&& rhs) -> expr { return std::forward<L>(lhs) * std::forward<R>(rhs); }
+
+  template<typename L, typename R>
+  auto div(L&& lhs, R&& rhs) -> expr { return std::forward<L>(lhs) / std::forward<R>(rhs); }
+
+  auto simplify(expr const& e) -> expr { return bt::iter::simplify(e); }
+  auto copy(expr const& e) -> expr { return e; }
+  auto release(expr& e) -> void { bt::iter::destroy(e); }
+};
+
+// Expressions are plain words: copying is free and the nodes are released
+// all at once with the pool.
+struct tagged_backend {
+  using expr = tg::expr;
+
+  auto num(int64_t n) -> expr { return m_pool.num(n); }
+  auto var(char const* name) -> expr { return m_pool.var(name); }
+  auto add(expr lhs, expr rhs) -> expr { return m_pool.add(lhs, rhs); }
+  auto mul(expr lhs, expr rhs) -> expr { return m_pool.mul(lhs, rhs); }
+  auto div(expr lhs, expr rhs) -> expr { return m_pool.div(lhs, rhs); }
+
+  auto simplify(expr e) -> expr { return tg::simplify(m_pool, e); }
+  auto copy(expr e) -> expr { return e; }
+  auto release(expr&) -> void { m_pool.clear(); }
+
+ private:
+  tg::pool m_pool;
+};
+
+// The chain that expr_va.cc and expr_bt.cc used to build: e0 is copied into
+// every new node.
+struct chain_copy {
+  template<typename B>
+  static auto build(B& b, int64_t n) -> typename B::expr {
+    auto e0 = b.add(b.mul(b.add(b.num(1), b.mul(b.num(0), b.var("x"))), b.num(3)), b.num(12));
+    for (auto j = 0; j < n; ++j) {
+      if (j % 2)
+        e0 = b.div(e0, b.num(2));
+      else
+        e0 = b.add(b.mul(b.num(3), e0), b.num(1));
+    }
+    return e0;
+  }
+};
+
+// Same expression, but e0 is moved into the new nodes.
+struct chain_move {
+  template<typename B>
+  static auto build(B& b, int64_t n) -> typename B::expr {
+    auto e0 = b.add(b.mul(b.add(b.num(1), b.mul(b.num(0), b.var("x"))), b.num(3)), b.num(12));
+    for (auto j = 0; j < n; ++j) {
+      if (j % 2)
+        e0 = b.div(std::move(e0), b.num(2));
+      else
+        e0 = b.add(b.mul(b.num(3), std::move(e0)), b.num(1));
+    }
+    return e0;
+  }
+};
+
+// A random tree with 2^n leaves, a third of them variables.
+struct balanced {
+  template<typename B>
+  static auto build(B& b, int64_t n) -> typename B::expr {
+    auto rng = std::mt19937_64(n);
+    return build(b, rng, n);
+  }
+
+  template<typename B>
+  static auto build(B& b, std::mt19937_64& rng, int64_t n) -> typename B::expr {
+    auto unif = std::uniform_int_distribution<int>(0, 5);
+    if (n == 0) {
+      auto const x = unif(rng);
+      return x < 2? b.var("x") : b.num(x - 2);
+    }
+    auto l = build(b, rng, n - 1);
+    auto r = build(b, rng, n - 1);
+    switch (unif(rng) % 3) {
+      case 0: return b.add(std::move(l), std::move(r));
+      case 1: return b.mul(std::move(l), std::move(r));
+      default: return b.div(std::move(l), b.add(std::move(r), b.var("x")));
+    }
+  }
+};
+
+template<typename Backend, typename Workload>
+static void BM_ExprCreate(benchmark::State& state) {
+  auto b = Backend{};
+  while (state.KeepRunning()) {
+    auto e0 = Workload::build(b, state.range(0));
+    state.PauseTiming();
+    b.release(e0);
+    state.ResumeTiming();
+  }
+}
+
+template<typename Backend, typename Workload>
+static void BM_ExprSimplify(benchmark::State& state) {
+  auto b = Backend{};
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    auto e0 = Workload::build(b, state.range(0));
+    state.ResumeTiming();
+    auto s0 = b.simplify(e0);
+    state.PauseTiming();
+    b.release(s0);
+    b.release(e0);
+    state.ResumeTiming();
+  }
+}
+
+template<typename Backend, typename Workload>
+static void BM_ExprCopy(benchmark::State& state) {
+  auto b = Backend{};
+  auto e0 = Workload::build(b, state.range(0));
+  while (state.KeepRunning()) {
+    auto c0 = b.copy(e0);
+    benchmark::DoNotOptimize(c0);
+    state.PauseTiming();
+    // The tagged backend frees the pool, and with it e0.
+    if constexpr (!std::is_same_v<Backend, tagged_backend>) b.release(c0);
+    state.ResumeTiming();
+  }
+  b.release(e0);
+}
+
+template<typename Backend, typename Workload>
+static void BM_ExprDestroy(benchmark::State& state) {
+  auto b = Backend{};
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    auto e0 = Workload::build(b, state.range(0));
+    state.ResumeTiming();
+    b.release(e0);
+  }
+}
+
+#define EXPR_CHAIN_BENCHMARK(bm, backend, workload)  \
+  BENCHMARK_TEMPLATE2(bm, backend, workload)         \
+      ->Args({1})                                    \
+      ->Args({15})                                   \
+      ->Args({1000})
+
+#define EXPR_BALANCED_BENCHMARK(bm, backend)         \
+  BENCHMARK_TEMPLATE2(bm, backend, balanced)         \
+      ->Args({10})                                   \
+      ->Args({16})
+
+#define EXPR_BENCHMARKS(bm)                                  \
+  EXPR_CHAIN_BENCHMARK(bm, std17_backend, chain_copy);       \
+  EXPR_CHAIN_BENCHMARK(bm, std17_backend, chain_move);       \
+  EXPR_CHAIN_BENCHMARK(bm, boost_backend, chain_copy);       \
+  EXPR_CHAIN_BENCHMARK(bm, boost_backend, chain_move);       \
+  EXPR_CHAIN_BENCHMARK(bm, tagged_backend, chain_copy);      \
+  EXPR_BALANCED_BENCHMARK(bm, std17_backend);                \
+  EXPR_BALANCED_BENCHMARK(bm, boost_backend);                \
+  EXPR_BALANCED_BENCHMARK(bm, tagged_backend)
+
+EXPR_BENCHMARKS(BM_ExprCreate);
+EXPR_BENCHMARKS(BM_ExprSimplify);
+EXPR_BENCHMARKS(BM_ExprCopy);
+EXPR_BENCHMARKS(BM_ExprDestroy);
@@ -0,0 +1,60 @@
+#include "benchmark/benchmark.h"
+#include "expr/va_par.hh"
+#include <random>
+
+// A random, roughly balanced expression with 2^depth leaves. The chains of
+// expr_matrix.cc have no independent subtrees to simplify in parallel.
+static auto balanced(std::mt19937_64& rng, int64_t depth) -> va::expr {
+  auto unif = std::uniform_int_distribution<int>(0, 7);
+  if (depth == 0) {
+    auto const x = unif(rng);
+    return x < 2? va::expr{"x"} : va::expr{x - 2};
+  }
+  auto const l = balanced(rng, depth - 1);
+  auto const r = balanced(rng, depth - 1);
+  switch (unif(rng) % 4) {
+    case 0: return l + r;
+    case 1: return l - r;
+    case 2: return l * r;
+    default: return l / (r + va::expr{"x"});
+  }
+}
+
+static void BM_Std17Expr_BalancedSimplify(benchmark::State& state) {
+  auto rng = std::mt19937_64(state.range(0));
+  auto e0 = balanced(rng, state.range(0));
+  while (state.KeepRunning()) {
+    auto s0 = va::iter::simplify(e0);
+    state.PauseTiming();
+    va::iter::destroy(s0);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_Std17Expr_BalancedSimplify)
+    ->Args({14})
+    ->Args({18})
+    ->UseRealTime();
+
+// The second argument is the size of the pool. The pool's threads are the
+// ones doing the work, so this replaces the harness's ThreadRange(), which
+// would run independent copies of the benchmark instead.
+static void BM_Std17Expr_ParallelSimplify(benchmark::State& state) {
+  auto rng = std::mt19937_64(state.range(0));
+  auto e0 = balanced(rng, state.range(0));
+  auto pool = par::pool(state.range(1));
+  while (state.KeepRunning()) {
+    auto s0 = va::par::simplify(pool, e0);
+    state.PauseTiming();
+    va::iter::destroy(s0);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_Std17Expr_ParallelSimplify)
+    ->Args({14, 1})
+    ->Args({14, 2})
+    ->Args({14, 4})
+    ->Args({18, 1})
+    ->Args({18, 2})
+    ->Args({18, 4})
+    ->Args({18, 8})
+    ->UseRealTime();
@@ -0,0 +1,120 @@
+#include "benchmark/benchmark.h"
+#include "expr/tg.hh"
+#include "expr/va_iter.hh"
+#include "expr/bt_iter.hh"
+#include <string>
+
+static auto build_tg(tg::pool& p, int64_t depth) -> tg::expr {
+  auto e0 = p.add(p.mul(p.add(p.num(1), p.mul(p.num(0), p.var("x"))), p.num(3)), p.num(12));
+  for (auto j = 0; j < depth; ++j) {
+    if (j % 2)
+      e0 = p.div(e0, p.num(2));
+    else
+      e0 = p.add(p.mul(p.num(3), e0), p.num(1));
+  }
+  return e0;
+}
+
+static void BM_TaggedExpr_Creates(benchmark::State& state) {
+  auto p = tg::pool{};
+  while (state.KeepRunning()) {
+    auto const e0 = build_tg(p, state.range(0));
+    benchmark::DoNotOptimize(e0);
+    p.clear();
+  }
+}
+BENCHMARK(BM_TaggedExpr_Creates)
+    ->Args({1})
+    ->Args({5})
+    ->Args({10})
+    ->Args({15});
+
+static void BM_TaggedExpr_Simplify(benchmark::State& state) {
+  auto p = tg::pool{};
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    p.clear();
+    auto const e0 = build_tg(p, state.range(0));
+    state.ResumeTiming();
+    auto const s0 = tg::simplify(p, e0);
+    benchmark::DoNotOptimize(s0);
+  }
+}
+BENCHMARK(BM_TaggedExpr_Simplify)
+    ->Args({1})
+    ->Args({5})
+    ->Args({10})
+    ->Args({15})
+    ->Args({1000000});
+
+// Memory footprint: bytes used by the whole expression divided by its number
+// of nodes and leaves. For 'va' each node costs a make_shared block (the node
+// plus a ~16-byte control block), for 'bt' a heap-allocated node; in both
+// cases leaves are stored inline in the 40-byte variants of their parent.
+
+static auto label_bytes_per_node(benchmark::State& state, size_t bytes, size_t nodes) -> void {
+  state.SetLabel("bytes/node: " + std::to_string(double(bytes) / nodes));
+}
+
+static void BM_Std17Expr_Footprint(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    va::expr e0 = (va::expr{1} + va::expr{0} * va::expr{"x"}) * va::expr{3} + va::expr{12};
+    for (auto j = 0; j < state.range(0); ++j) {
+      if (j % 2)
+        e0 = e0 / va::expr{2};
+      else
+        e0 = va::expr{3} * e0 + va::expr{1};
+    }
+    state.PauseTiming();
+    auto const bytes = sizeof(va::expr) + va::iter::fold<size_t>(e0,
+      [](auto const& t, auto... children) -> size_t {
+        if constexpr (sizeof...(children) == 0) return 0;
+        else return sizeof(t) + 2 * sizeof(void*) + (0 + ... + children);
+      });
+    label_bytes_per_node(state, bytes, va::iter::size(e0));
+    va::iter::destroy(e0);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_Std17Expr_Footprint)
+    ->Args({15})
+    ->Args({1000});
+
+static void BM_BoostExpr_Footprint(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    bt::expr e0 = (bt::expr{1} + bt::expr{0} * bt::expr{"x"}) * bt::expr{3} + bt::expr{12};
+    for (auto j = 0; j < state.range(0); ++j) {
+      if (j % 2)
+        e0 = e0 / bt::expr{2};
+      else
+        e0 = bt::expr{3} * e0 + bt::expr{1};
+    }
+    state.PauseTiming();
+    auto const bytes = sizeof(bt::expr) + bt::iter::fold<size_t>(e0,
+      [](auto const& t, auto... children) -> size_t {
+        if constexpr (sizeof...(children) == 0) return 0;
+        else return (sizeof(t) + ... + children);
+      });
+    label_bytes_per_node(state, bytes, bt::iter::size(e0));
+    bt::iter::destroy(e0);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_BoostExpr_Footprint)
+    ->Args({15})
+    ->Args({1000});
+
+static void BM_TaggedExpr_Footprint(benchmark::State& state) {
+  auto p = tg::pool{};
+  while (state.KeepRunning()) {
+    auto const e0 = build_tg(p, state.range(0));
+    state.PauseTiming();
+    auto const bytes = sizeof(tg::expr) + p.nodes() * sizeof(tg::node);
+    label_bytes_per_node(state, bytes, tg::size(e0));
+    p.clear();
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_TaggedExpr_Footprint)
+    ->Args({15})
+    ->Args({1000});
@@ -1,91 +1,234 @@
 #include "benchmark/benchmark.h"
 #include "benchset/insert_unique.hh"
+#include "benchset/learned_set.hh"
+#include "benchset/myflat.hh"
+#include "benchset/roaring.hh"
+#include "benchset/static_search.hh"
+#include "benchset/swiss_set.hh"
+#include "workload.hh"
+#include <algorithm>
 #include <random>
+#include <string>
 #include <set>
 #include <vector>
 #include <unordered_set>
 #include <boost/container/flat_set.hpp>
 
-static void BM_FindFromHalfFilledStdSet(benchmark::State& state) {
-  while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = std::set<int>{};
+// Sets of n keys from [0, 2n), of each distribution of workload.hh, and n
+// lookups in them, half of which hit, drawn before timing.
+static auto half_filled_input(benchmark::State const& state) -> std::pair<std::vector<int>, std::vector<int>> {
+  auto const n = int(state.range(0));
+  auto const d = workload::dist(state.range(1));
+  auto rng = std::mt19937_64(n);
+  auto keys = workload::keys(rng, d, n, 2 * n);
+  auto sorted = keys;
+  std::sort(sorted.begin(), sorted.end());
+  return {std::move(keys), workload::queries(rng, d, sorted, n)};
+}
 
-    auto unif = std::uniform_int_distribution<int>(state.range(0) * 2);
-    auto rng = std::mt19937_64(state.range(0));
+static void half_filled_args(benchmark::internal::Benchmark* b) {
+  for (auto d : workload::dists)
+    for (auto n : {100, 1000, 10000, 100000})
+      b->Args({n, int(d)});
+}
 
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
+static void BM_FindFromHalfFilledStdSet(benchmark::State& state) {
+  auto const [keys, qs] = half_filled_input(state);
+  auto xs = std::set<int>{};
+  for (auto k : keys) xs.insert(k);
 
-    state.ResumeTiming();
-    for (auto i = 0; i < state.range(0); ++i)
-      xs.find(unif(rng));
-  }
+  while (state.KeepRunning())
+    for (auto q : qs) benchmark::DoNotOptimize(xs.find(q));
+  state.SetLabel(workload::name(workload::dist(state.range(1))));
 }
-BENCHMARK(BM_FindFromHalfFilledStdSet)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_FindFromHalfFilledStdSet)->Apply(half_filled_args);
 
 static void BM_FindFromHalfFilledFlatSet(benchmark::State& state) {
-  while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = boost::container::flat_set<int>{};
+  auto const [keys, qs] = half_filled_input(state);
+  auto xs = boost::container::flat_set<int>{};
+  for (auto k : keys) xs.insert(k);
 
-    auto unif = std::uniform_int_distribution<int>(state.range(0) * 2);
-    auto rng = std::mt19937_64(state.range(0));
+  while (state.KeepRunning())
+    for (auto q : qs) benchmark::DoNotOptimize(xs.find(q));
+  state.SetLabel(workload::name(workload::dist(state.range(1))));
+}
+BENCHMARK(BM_FindFromHalfFilledFlatSet)->Apply(half_filled_args);
 
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
+static void BM_FindFromHalfFilledUSet(benchmark::State& state) {
+  auto const [keys, qs] = half_filled_input(state);
+  auto xs = std::unordered_set<int>{};
+  for (auto k : keys) xs.insert(k);
 
-    state.ResumeTiming();
-    for (auto i = 0; i < state.range(0); ++i)
-      xs.find(unif(rng));
-  }
+  while (state.KeepRunning())
+    for (auto q : qs) benchmark::DoNotOptimize(xs.find(q));
+  state.SetLabel(workload::name(workload::dist(state.range(1))));
 }
-BENCHMARK(BM_FindFromHalfFilledFlatSet)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_FindFromHalfFilledUSet)->Apply(half_filled_args);
 
-static void BM_FindFromHalfFilledUSet(benchmark::State& state) {
-  while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = std::unordered_set<int>{};
+static void BM_FindFromHalfFilledSwissSet(benchmark::State& state) {
+  auto const [keys, qs] = half_filled_input(state);
+  auto xs = benchunion::swiss_set<int>{};
+  for (auto k : keys) xs.insert(k);
+
+  while (state.KeepRunning())
+    for (auto q : qs) benchmark::DoNotOptimize(xs.find(q));
+  state.SetLabel(workload::name(workload::dist(state.range(1))));
+}
+BENCHMARK(BM_FindFromHalfFilledSwissSet)->Apply(half_filled_args);
+
+static void BM_FindFromHalfFilledVector(benchmark::State& state) {
+  auto const [keys, qs] = half_filled_input(state);
+  auto xs = std::vector<int>{};
+  for (auto k : keys) benchunion::insert_unique(xs, k);
+
+  while (state.KeepRunning())
+    for (auto q : qs) benchmark::DoNotOptimize(std::lower_bound(xs.begin(), xs.end(), q));
+  state.SetLabel(workload::name(workload::dist(state.range(1))));
+}
+BENCHMARK(BM_FindFromHalfFilledVector)->Apply(half_filled_args);
+
+static void BM_FindFromHalfFilledRoaring(benchmark::State& state) {
+  auto const [keys, qs] = half_filled_input(state);
+  auto xs = benchunion::roaring_set{};
+  for (auto k : keys) xs.insert(k);
+
+  while (state.KeepRunning())
+    for (auto q : qs) benchmark::DoNotOptimize(xs.contains(q));
+  state.SetLabel(std::string(workload::name(workload::dist(state.range(1)))) +
+                 " bytes/elem: " + std::to_string(double(xs.bytes()) / keys.size()));
+}
+BENCHMARK(BM_FindFromHalfFilledRoaring)->Apply(half_filled_args);
+
+// Run-optimized: every chunk is at least half full.
+static void BM_FindFromHalfFilledRoaringDense(benchmark::State& state) {
+  auto const [keys, qs] = half_filled_input(state);
+  auto xs = benchunion::roaring_set{};
+  for (auto k : keys) xs.insert(k);
+  xs.run_optimize();
+
+  while (state.KeepRunning())
+    for (auto q : qs) benchmark::DoNotOptimize(xs.contains(q));
+  state.SetLabel(std::string(workload::name(workload::dist(state.range(1)))) +
+                 " bytes/elem: " + std::to_string(double(xs.bytes()) / keys.size()));
+}
+BENCHMARK(BM_FindFromHalfFilledRoaringDense)->Apply(half_filled_args);
+
+// Sets built once from n sorted keys, with up to 10^8 keys: rebuilding them
+// for every iteration, as above, would take longer than the lookups. The
+// keys come from [0, 2n) and half the lookups hit. Only sequential keys,
+// built in linear time, go past 10^7.
+struct static_input {
+  explicit static_input(benchmark::State const& state) {
+    auto const n = int(state.range(0));
+    auto const d = workload::dist(state.range(1));
+    auto rng = std::mt19937_64(n);
+    keys = workload::sorted_keys(rng, d, n, 2 * int64_t{n});
+    queries = workload::queries(rng, d, keys, 1 << 16);
+  }
+
+  std::vector<int> keys;
+  std::vector<int> queries;
+};
 
-    auto unif = std::uniform_int_distribution<int>(state.range(0) * 2);
-    auto rng = std::mt19937_64(state.range(0));
+static void static_sizes(benchmark::internal::Benchmark* b, int from) {
+  for (auto d : workload::dists)
+    for (auto n = from; n <= (d == workload::dist::sequential? 100000000 : 10000000); n *= 10)
+      b->Args({n, int(d)});
+}
+
+static void static_args(benchmark::internal::Benchmark* b) { static_sizes(b, 1000); }
+static void batch_args(benchmark::internal::Benchmark* b) { static_sizes(b, 1000000); }
 
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
+// The baseline: std::lower_bound over the sorted keys.
+struct lower_bound_set {
+  explicit lower_bound_set(std::vector<int> const& sorted) : keys(sorted) {}
 
-    state.ResumeTiming();
-    for (auto i = 0; i < state.range(0); ++i)
-      xs.find(unif(rng));
+  auto contains(int x) const -> bool {
+    auto const it = std::lower_bound(keys.begin(), keys.end(), x);
+    return it != keys.end() && *it == x;
   }
+
+  std::vector<int> keys;
+};
+
+// my::flat_set::find, whose search the learned index bounds.
+struct flat_set_find {
+  explicit flat_set_find(std::vector<int> const& sorted) : keys(my::ordered_unique_range, sorted) {}
+
+  auto contains(int x) const -> bool { return keys.find(x) != keys.end(); }
+
+  my::flat_set<int> keys;
+};
+
+template<typename Set>
+static void BM_FindStatic(benchmark::State& state) {
+  auto const input = static_input(state);
+  auto const set = Set(input.keys);
+  auto const& qs = input.queries;
+
+  auto i = size_t{0};
+  while (state.KeepRunning())
+    benchmark::DoNotOptimize(set.contains(qs[i++ & (qs.size() - 1)]));
+  state.SetItemsProcessed(state.iterations());
+  state.SetLabel(workload::name(workload::dist(state.range(1))));
+}
+BENCHMARK_TEMPLATE(BM_FindStatic, lower_bound_set)->Apply(static_args);
+BENCHMARK_TEMPLATE(BM_FindStatic, benchunion::branchless_set<int>)->Apply(static_args);
+BENCHMARK_TEMPLATE(BM_FindStatic, benchunion::eytzinger_set<int>)->Apply(static_args);
+BENCHMARK_TEMPLATE(BM_FindStatic, benchunion::stree_set<int>)->Apply(static_args);
+BENCHMARK_TEMPLATE(BM_FindStatic, flat_set_find)->Apply(static_args);
+BENCHMARK_TEMPLATE(BM_FindStatic, benchunion::learned_set<int, 16>)->Apply(static_args);
+BENCHMARK_TEMPLATE(BM_FindStatic, benchunion::learned_set<int, 64>)->Apply(static_args);
+
+// Batches of lookups, one at a time or interleaved with find_batch, in
+// containers out of the caches. The keys are those of BM_FindStatic.
+static auto from_keys(std::vector<int> const& keys, my::flat_set<int>*) -> my::flat_set<int> {
+  return my::flat_set<int>(my::ordered_unique_range, keys);
 }
-BENCHMARK(BM_FindFromHalfFilledUSet)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
 
-static void BM_FindFromHalfFilledVector(benchmark::State& state) {
-  while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = std::vector<int>{};
+static auto from_keys(std::vector<int> const& keys, my::flat_map<int, int>*) -> my::flat_map<int, int> {
+  auto ps = std::vector<my::pair<int, int>>{};
+  ps.reserve(keys.size());
+  for (auto k : keys) ps.emplace_back(k, k);
+  return my::flat_map<int, int>(my::ordered_unique_range, std::move(ps));
+}
+
+constexpr auto lookup_batch = 1024;
 
-    auto unif = std::uniform_int_distribution<int>(state.range(0) * 2);
-    auto rng = std::mt19937_64(state.range(0));
+template<typename Map>
+static void BM_FindOneByOne(benchmark::State& state) {
+  auto const input = static_input(state);
+  auto const xs = from_keys(input.keys, static_cast<Map*>(nullptr));
+  auto const& qs = input.queries;
+  auto found = std::vector<typename Map::const_iterator>(lookup_batch);
 
-    while ((signed)xs.size() < state.range(0)) benchunion::insert_unique(xs, unif(rng));
+  auto i = size_t{0};
+  while (state.KeepRunning()) {
+    auto const* q = &qs[i++ * lookup_batch % qs.size()];
+    for (auto j = 0; j < lookup_batch; ++j) found[j] = xs.find(q[j]);
+    benchmark::DoNotOptimize(found.data());
+  }
+  state.SetItemsProcessed(state.iterations() * lookup_batch);
+  state.SetLabel(workload::name(workload::dist(state.range(1))));
+}
+BENCHMARK_TEMPLATE(BM_FindOneByOne, my::flat_set<int>)->Apply(batch_args);
+BENCHMARK_TEMPLATE(BM_FindOneByOne, my::flat_map<int, int>)->Apply(batch_args);
 
-    state.ResumeTiming();
-    for (auto i = 0; i < state.range(0); ++i)
-      std::lower_bound(xs.begin(), xs.end(), unif(rng));
+template<typename Map>
+static void BM_FindBatch(benchmark::State& state) {
+  auto const input = static_input(state);
+  auto const xs = from_keys(input.keys, static_cast<Map*>(nullptr));
+  auto const& qs = input.queries;
+  auto found = std::vector<typename Map::const_iterator>(lookup_batch);
+
+  auto i = size_t{0};
+  while (state.KeepRunning()) {
+    auto const* q = &qs[i++ * lookup_batch % qs.size()];
+    xs.find_batch(q, q + lookup_batch, found.begin());
+    benchmark::DoNotOptimize(found.data());
   }
+  state.SetItemsProcessed(state.iterations() * lookup_batch);
+  state.SetLabel(workload::name(workload::dist(state.range(1))));
 }
-BENCHMARK(BM_FindFromHalfFilledVector)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK_TEMPLATE(BM_FindBatch, my::flat_set<int>)->Apply(batch_args);
+BENCHMARK_TEMPLATE(BM_FindBatch, my::flat_map<int, int>)->Apply(batch_args);
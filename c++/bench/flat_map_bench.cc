@@ -0,0 +1,88 @@
+#include "benchmark/benchmark.h"
+#include "benchset/myflat.hh"
+#include "benchset/split_flat_map.hh"
+#include "workload.hh"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// Finds in maps of n int keys from [0, 2n), of the distribution of the
+// second argument, to values of B bytes: with the pairs stored together,
+// every probe of the binary search brings the bytes of a value along with
+// its key. Half the finds hit.
+template<size_t B>
+struct payload {
+  static_assert(B % sizeof(int) == 0, "payloads are made of ints");
+  int words[B / sizeof(int)];
+};
+
+template<template<typename, typename> class Map, size_t B>
+static void BM_FindMapByValueSize(benchmark::State& state) {
+  auto const n = state.range(0);
+  auto const d = workload::dist(state.range(1));
+  auto rng = std::mt19937_64(n);
+  auto const keys = workload::keys(rng, d, n, 2 * n);
+  auto ps = std::vector<std::pair<int, payload<B>>>(n);
+  for (auto i = 0; i < n; ++i) ps[i].first = keys[i];
+  auto const xs = Map<int, payload<B>>(ps.begin(), ps.end());
+
+  auto sorted = keys;
+  std::sort(sorted.begin(), sorted.end());
+  auto const queries = workload::queries(rng, d, sorted, n);
+
+  while (state.KeepRunning())
+    for (auto q : queries) benchmark::DoNotOptimize(xs.find(q) != xs.end());
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetLabel(std::string(workload::name(d)) + ", " + std::to_string(B) + " byte values");
+}
+
+// Inserts into an empty map until it has n keys, as above, in their
+// insertion order: the pairs, or the keys and the values, after the
+// insertion point move by one.
+template<template<typename, typename> class Map, size_t B>
+static void BM_InsertMapByValueSize(benchmark::State& state) {
+  auto const n = state.range(0);
+  auto const d = workload::dist(state.range(1));
+  auto rng = std::mt19937_64(n);
+  auto const keys = workload::keys(rng, d, n, 2 * n);
+
+  while (state.KeepRunning()) {
+    auto xs = Map<int, payload<B>>{};
+    for (auto k : keys) xs.insert({k, payload<B>{}});
+    benchmark::DoNotOptimize(xs.size());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetLabel(std::string(workload::name(d)) + ", " + std::to_string(B) + " byte values");
+}
+
+static void find_map_args(benchmark::internal::Benchmark* b) {
+  for (auto d : workload::dists)
+    for (auto n : {1000, 10000, 100000})
+      b->Args({n, int(d)});
+}
+
+static void insert_map_args(benchmark::internal::Benchmark* b) {
+  for (auto d : workload::dists) b->Args({10000, int(d)});
+}
+
+template<typename Key, typename Value>
+using std_map = std::map<Key, Value>;
+
+#define VALUE_SIZE_BENCHMARKS(B)                                         \
+  BENCHMARK_TEMPLATE2(BM_FindMapByValueSize, std_map, B)                 \
+      ->Apply(find_map_args);                                            \
+  BENCHMARK_TEMPLATE2(BM_FindMapByValueSize, my::flat_map, B)            \
+      ->Apply(find_map_args);                                            \
+  BENCHMARK_TEMPLATE2(BM_FindMapByValueSize, my::split_flat_map, B)      \
+      ->Apply(find_map_args);                                            \
+  BENCHMARK_TEMPLATE2(BM_InsertMapByValueSize, my::flat_map, B)          \
+      ->Apply(insert_map_args);                                          \
+  BENCHMARK_TEMPLATE2(BM_InsertMapByValueSize, my::split_flat_map, B)    \
+      ->Apply(insert_map_args)
+
+VALUE_SIZE_BENCHMARKS(4);
+VALUE_SIZE_BENCHMARKS(16);
+VALUE_SIZE_BENCHMARKS(64);
+VALUE_SIZE_BENCHMARKS(256);
@@ -1,122 +1,181 @@
 #include "benchmark/benchmark.h"
 #include "benchset/insert_unique.hh"
 #include "benchset/myflat.hh"
+#include "benchset/roaring.hh"
+#include "benchset/swiss_set.hh"
+#include "workload.hh"
+#include <algorithm>
 #include <random>
+#include <string>
 #include <set>
 #include <vector>
 #include <unordered_set>
 #include <boost/container/flat_set.hpp>
 
+// n distinct keys of each distribution of workload.hh, over about 2^30
+// values or, for the dense sets, over [0, 2n), in the order to insert them.
+// They are drawn once, before timing; each iteration inserts them all in a
+// new set.
+static auto insert_input(benchmark::State const& state, int64_t universe) -> std::vector<int> {
+  auto rng = std::mt19937_64(state.range(0));
+  return workload::keys(rng, workload::dist(state.range(1)), state.range(0), universe);
+}
+
+static void insert_args(benchmark::internal::Benchmark* b) {
+  for (auto d : workload::dists)
+    for (auto n : {10, 100, 1000, 10000, 100000})
+      b->Args({n, int(d)});
+}
+
+static auto label(benchmark::State& state) -> std::string {
+  return workload::name(workload::dist(state.range(1)));
+}
+
 static void BM_InsertIntoStdSet(benchmark::State& state) {
+  auto const keys = insert_input(state, workload::wide);
   while (state.KeepRunning()) {
-    state.PauseTiming();
     auto xs = std::set<int>{};
-
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
-
-    state.ResumeTiming();
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
+    for (auto k : keys) xs.insert(k);
+    benchmark::DoNotOptimize(xs.size());
   }
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_InsertIntoStdSet)
-    ->Args({10})
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_InsertIntoStdSet)->Apply(insert_args);
 
 static void BM_InsertIntoFlatSet(benchmark::State& state) {
+  auto const keys = insert_input(state, workload::wide);
   while (state.KeepRunning()) {
-    state.PauseTiming();
     auto xs = boost::container::flat_set<int>{};
+    for (auto k : keys) xs.insert(k);
+    benchmark::DoNotOptimize(xs.size());
+  }
+  state.SetLabel(label(state));
+}
+BENCHMARK(BM_InsertIntoFlatSet)->Apply(insert_args);
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
+static void BM_InsertIntoMyFlatSet(benchmark::State& state) {
+  auto const keys = insert_input(state, workload::wide);
+  while (state.KeepRunning()) {
+    auto xs = my::flat_set<int>{};
+    for (auto k : keys) xs.insert(k);
+    benchmark::DoNotOptimize(xs.size());
+  }
+  state.SetLabel(label(state));
+}
+BENCHMARK(BM_InsertIntoMyFlatSet)->Apply(insert_args);
 
-    state.ResumeTiming();
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
+// The same keys, inserted at once: one sort and one merge.
+static void BM_InsertRangeIntoMyFlatSet(benchmark::State& state) {
+  auto const keys = insert_input(state, workload::wide);
+  while (state.KeepRunning()) {
+    auto xs = my::flat_set<int>{};
+    xs.insert_range(keys.begin(), keys.end());
+    benchmark::DoNotOptimize(xs.size());
   }
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_InsertIntoFlatSet)
-    ->Args({10})
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_InsertRangeIntoMyFlatSet)->Apply(insert_args);
 
-static void BM_InsertIntoMyFlatSet(benchmark::State& state) {
+// Half of the keys into a set holding the other half: the merge is linear.
+static void BM_InsertRangeIntoHalfFilledMyFlatSet(benchmark::State& state) {
+  auto const keys = insert_input(state, workload::wide);
+  auto const half = keys.begin() + keys.size() / 2;
   while (state.KeepRunning()) {
     state.PauseTiming();
-    auto xs = my::flat_set<int>{};
+    auto xs = my::flat_set<int>(keys.begin(), half);
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
+    state.ResumeTiming();
+    xs.insert_range(half, keys.end());
+  }
+  state.SetLabel(label(state));
+}
+BENCHMARK(BM_InsertRangeIntoHalfFilledMyFlatSet)->Apply(insert_args);
+
+// Keys already sorted, as they come from another sorted container.
+static void BM_AdoptSortedIntoMyFlatSet(benchmark::State& state) {
+  auto sorted = insert_input(state, workload::wide);
+  std::sort(sorted.begin(), sorted.end());
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    auto keys = sorted;
 
     state.ResumeTiming();
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
+    auto xs = my::flat_set<int>(my::ordered_unique_range, std::move(keys));
+    benchmark::DoNotOptimize(xs.data());
   }
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_InsertIntoMyFlatSet)
-    ->Args({10})
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_AdoptSortedIntoMyFlatSet)->Apply(insert_args);
 
 static void BM_InsertIntoUSet(benchmark::State& state) {
+  auto const keys = insert_input(state, workload::wide);
   while (state.KeepRunning()) {
-    state.PauseTiming();
     auto xs = std::unordered_set<int>{};
+    for (auto k : keys) xs.insert(k);
+    benchmark::DoNotOptimize(xs.size());
+  }
+  state.SetLabel(label(state));
+}
+BENCHMARK(BM_InsertIntoUSet)->Apply(insert_args);
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
-
-    state.ResumeTiming();
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
+static void BM_InsertIntoSwissSet(benchmark::State& state) {
+  auto const keys = insert_input(state, workload::wide);
+  while (state.KeepRunning()) {
+    auto xs = benchunion::swiss_set<int>{};
+    for (auto k : keys) xs.insert(k);
+    benchmark::DoNotOptimize(xs.size());
   }
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_InsertIntoUSet)
-    ->Args({10})
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_InsertIntoSwissSet)->Apply(insert_args);
 
 static void BM_InsertIntoUniqueVector(benchmark::State& state) {
+  auto const keys = insert_input(state, workload::wide);
   while (state.KeepRunning()) {
-    state.PauseTiming();
     auto xs = std::vector<int>{};
-
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
-
-    state.ResumeTiming();
-    while ((signed)xs.size() < state.range(0)) benchunion::insert_unique(xs, unif(rng));
+    for (auto k : keys) benchunion::insert_unique(xs, k);
+    benchmark::DoNotOptimize(xs.size());
   }
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_InsertIntoUniqueVector)
-    ->Args({10})
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_InsertIntoUniqueVector)->Apply(insert_args);
 
 static void BM_InsertIntoUniqueVectorNoBack(benchmark::State& state) {
+  auto const keys = insert_input(state, workload::wide);
   while (state.KeepRunning()) {
-    state.PauseTiming();
     auto xs = std::vector<int>{};
+    for (auto k : keys) benchunion::insert_unique_noback(xs, k);
+    benchmark::DoNotOptimize(xs.size());
+  }
+  state.SetLabel(label(state));
+}
+BENCHMARK(BM_InsertIntoUniqueVectorNoBack)->Apply(insert_args);
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
+static void BM_InsertIntoRoaring(benchmark::State& state) {
+  auto const keys = insert_input(state, workload::wide);
+  auto bytes = size_t{0};
+  while (state.KeepRunning()) {
+    auto xs = benchunion::roaring_set{};
+    for (auto k : keys) xs.insert(k);
+    state.PauseTiming();
+    bytes = xs.bytes();
+    state.ResumeTiming();
+  }
+  state.SetLabel(label(state) + " bytes/elem: " + std::to_string(double(bytes) / state.range(0)));
+}
+BENCHMARK(BM_InsertIntoRoaring)->Apply(insert_args);
 
+// Values from [0, 2n): every chunk is at least half full.
+static void BM_InsertIntoRoaringDense(benchmark::State& state) {
+  auto const keys = insert_input(state, 2 * state.range(0));
+  auto bytes = size_t{0};
+  while (state.KeepRunning()) {
+    auto xs = benchunion::roaring_set{};
+    for (auto k : keys) xs.insert(k);
+    state.PauseTiming();
+    bytes = xs.bytes();
     state.ResumeTiming();
-    while ((signed)xs.size() < state.range(0)) benchunion::insert_unique_noback(xs, unif(rng));
   }
+  state.SetLabel(label(state) + " bytes/elem: " + std::to_string(double(bytes) / state.range(0)));
 }
-BENCHMARK(BM_InsertIntoUniqueVectorNoBack)
-    ->Args({10})
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_InsertIntoRoaringDense)->Apply(insert_args);
@@ -1,157 +1,502 @@
 #include "benchmark/benchmark.h"
 #include "benchset/intersection.hh"
+#include "benchset/adaptive_intersection.hh"
+#include "benchset/simd_intersection.hh"
+#include "benchset/roaring.hh"
+#include "benchset/swiss_set.hh"
+#include "benchset/arena.hh"
+#include "benchset/myflat.hh"
+#include "workload.hh"
+#include <iterator>
 #include <random>
+#include <string>
+#include <type_traits>
 
-static void BM_IntersectionWithStdSetInsert(benchmark::State& state) {
-  while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = std::set<int>{};
-    auto ys = std::set<int>{};
+// Two sets of n keys of the distribution range(1) of workload.hh, range(2)
+// % of them in both, built once per benchmark. Sorted vectors are taken as
+// they are; the other sets are filled in insertion order, so that the
+// nodes of std::set lie as random inserts leave them.
+template<typename Set>
+static auto intersection_input(benchmark::State const& state, int64_t universe) -> std::pair<Set, Set> {
+  auto rng = std::mt19937_64(state.range(0));
+  auto const d = workload::dist(state.range(1));
+  auto [xs, ys] = workload::overlapping_keys(rng, d, state.range(0), state.range(2), universe);
+  if constexpr (std::is_same_v<Set, std::vector<int>>) {
+    return {std::move(xs), std::move(ys)};
+  } else {
+    auto const fill = [&](std::vector<int> const& keys) {
+      auto const order = workload::insertion_order(rng, d, keys);
+      return Set(order.begin(), order.end());
+    };
+    return {fill(xs), fill(ys)};
+  }
+}
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
+// Sizes and distributions, the sets sharing a quarter of their keys.
+static void intersection_args(benchmark::internal::Benchmark* b) {
+  for (auto d : workload::dists)
+    for (auto n : {100, 1000, 10000, 100000})
+      b->Args({n, int(d), 25});
+}
 
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
-    while ((signed)ys.size() < state.range(0)) ys.insert(unif(rng));
+static auto label(benchmark::State& state) -> std::string {
+  return workload::name(workload::dist(state.range(1)));
+}
 
-    state.ResumeTiming();
+static void BM_IntersectionWithStdSetInsert(benchmark::State& state) {
+  auto const [xs, ys] = intersection_input<std::set<int>>(state, workload::wide);
+  while (state.KeepRunning()) {
     auto z = benchunion::stdset_intersection(xs, ys);
+    benchmark::DoNotOptimize(z.size());
   }
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_IntersectionWithStdSetInsert)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_IntersectionWithStdSetInsert)->Apply(intersection_args);
 
 static void BM_IntersectionWithStdSetEmplaceHint(benchmark::State& state) {
+  auto const [xs, ys] = intersection_input<std::set<int>>(state, workload::wide);
   while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = std::set<int>{};
-    auto ys = std::set<int>{};
+    auto z = benchunion::stdset_intersection_eh(xs, ys);
+    benchmark::DoNotOptimize(z.size());
+  }
+  state.SetLabel(label(state));
+}
+BENCHMARK(BM_IntersectionWithStdSetEmplaceHint)->Apply(intersection_args);
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
+static void BM_IntersectionWithFlatSetInsert(benchmark::State& state) {
+  auto const [xs, ys] = intersection_input<boost::container::flat_set<int>>(state, workload::wide);
+  while (state.KeepRunning()) {
+    auto z = benchunion::flatset_intersection(xs, ys);
+    benchmark::DoNotOptimize(z.size());
+  }
+  state.SetLabel(label(state));
+}
+BENCHMARK(BM_IntersectionWithFlatSetInsert)->Apply(intersection_args);
 
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
-    while ((signed)ys.size() < state.range(0)) ys.insert(unif(rng));
+static void BM_IntersectionWithFlatSetEmplaceHint(benchmark::State& state) {
+  auto const [xs, ys] = intersection_input<boost::container::flat_set<int>>(state, workload::wide);
+  while (state.KeepRunning()) {
+    auto z = benchunion::flatset_intersection_eh(xs, ys);
+    benchmark::DoNotOptimize(z.size());
+  }
+  state.SetLabel(label(state));
+}
+BENCHMARK(BM_IntersectionWithFlatSetEmplaceHint)->Apply(intersection_args);
 
-    state.ResumeTiming();
-    auto z = benchunion::stdset_intersection_eh(xs, ys);
+static void BM_IntersectionWithUSetInsert(benchmark::State& state) {
+  auto const [xs, ys] = intersection_input<std::unordered_set<int>>(state, workload::wide);
+  while (state.KeepRunning()) {
+    auto z = benchunion::stduset_intersection(xs, ys);
+    benchmark::DoNotOptimize(z.size());
   }
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_IntersectionWithStdSetEmplaceHint)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_IntersectionWithUSetInsert)->Apply(intersection_args);
 
-static void BM_IntersectionWithFlatSetInsert(benchmark::State& state) {
+static void BM_IntersectionWithSwissSet(benchmark::State& state) {
+  auto const [xs, ys] = intersection_input<benchunion::swiss_set<int>>(state, workload::wide);
   while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = boost::container::flat_set<int>{};
-    auto ys = boost::container::flat_set<int>{};
+    auto z = benchunion::swissset_intersection(xs, ys);
+    benchmark::DoNotOptimize(z.size());
+  }
+  state.SetLabel(label(state));
+}
+BENCHMARK(BM_IntersectionWithSwissSet)->Apply(intersection_args);
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
+static void BM_IntersectionWithVector(benchmark::State& state) {
+  auto const [xs, ys] = intersection_input<std::vector<int>>(state, workload::wide);
+  while (state.KeepRunning()) {
+    auto z = benchunion::vectorset_intersection(xs, ys);
+    benchmark::DoNotOptimize(z.size());
+  }
+  state.SetLabel(label(state));
+}
+BENCHMARK(BM_IntersectionWithVector)->Apply(intersection_args);
 
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
-    while ((signed)ys.size() < state.range(0)) ys.insert(unif(rng));
+static void BM_IntersectionWithVectorNoBack(benchmark::State& state) {
+  auto const [xs, ys] = intersection_input<std::vector<int>>(state, workload::wide);
+  while (state.KeepRunning()) {
+    auto z = benchunion::vectorset_intersection_noback(xs, ys);
+    benchmark::DoNotOptimize(z.size());
+  }
+  state.SetLabel(label(state));
+}
+BENCHMARK(BM_IntersectionWithVectorNoBack)->Apply(intersection_args);
 
-    state.ResumeTiming();
-    auto z = benchunion::flatset_intersection(xs, ys);
+// Sorted sets over [0, 4n), for the kernels below, with up to 10^8 keys of
+// which only sequential ones, built in linear time, go past 10^7. At 10^6
+// keys, the sets also share none to all of them.
+static void kernel_args(benchmark::internal::Benchmark* b) {
+  for (auto d : workload::dists)
+    for (auto n = 1000; n <= (d == workload::dist::sequential? 100000000 : 10000000); n *= 10)
+      b->Args({n, int(d), 25});
+  for (auto d : workload::dists)
+    for (auto percent : {0, 50, 100})
+      b->Args({1000000, int(d), percent});
+}
+
+// The baseline for the kernels below, on the same inputs.
+static void BM_IntersectionWithVectorDense(benchmark::State& state) {
+  auto const [xs, ys] = intersection_input<std::vector<int>>(state, 4 * state.range(0));
+  while (state.KeepRunning()) {
+    auto z = benchunion::vectorset_intersection(xs, ys);
+    benchmark::DoNotOptimize(z.data());
   }
+  state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_IntersectionWithFlatSetInsert)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_IntersectionWithVectorDense)->Apply(kernel_args);
 
-static void BM_IntersectionWithFlatSetEmplaceHint(benchmark::State& state) {
+template<benchunion::simd::isa I>
+static void BM_IntersectionSimd(benchmark::State& state) {
+  if (!benchunion::simd::supported(I)) {
+    state.SkipWithError("not supported by this CPU");
+    return;
+  }
+  auto const [xs, ys] = intersection_input<std::vector<int>>(state, 4 * state.range(0));
+  auto out = std::vector<int>(state.range(0) + benchunion::simd::slack);
   while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = boost::container::flat_set<int>{};
-    auto ys = boost::container::flat_set<int>{};
+    auto n = benchunion::simd::intersect(I, xs.data(), xs.size(), ys.data(), ys.size(), out.data());
+    benchmark::DoNotOptimize(n);
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+  state.SetLabel(label(state));
+}
+
+using isa = benchunion::simd::isa;
+BENCHMARK_TEMPLATE(BM_IntersectionSimd, isa::scalar)->Apply(kernel_args);
+BENCHMARK_TEMPLATE(BM_IntersectionSimd, isa::sse42)->Apply(kernel_args);
+BENCHMARK_TEMPLATE(BM_IntersectionSimd, isa::avx2)->Apply(kernel_args);
+BENCHMARK_TEMPLATE(BM_IntersectionSimd, isa::avx512)->Apply(kernel_args);
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
+// Through the runtime dispatch, into a new flat_set.
+static void BM_IntersectionWithFlatSetSimd(benchmark::State& state) {
+  auto const [v, w] = intersection_input<std::vector<int>>(state, 4 * state.range(0));
+  auto const xs = boost::container::flat_set<int>(boost::container::ordered_unique_range, v.begin(), v.end());
+  auto const ys = boost::container::flat_set<int>(boost::container::ordered_unique_range, w.begin(), w.end());
+  while (state.KeepRunning()) {
+    auto z = benchunion::flatset_intersection_simd(xs, ys);
+    benchmark::DoNotOptimize(z.size());
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+  state.SetLabel(label(state) + " " + benchunion::simd::name(benchunion::simd::best_isa()));
+}
+BENCHMARK(BM_IntersectionWithFlatSetSimd)->Apply(kernel_args);
 
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
-    while ((signed)ys.size() < state.range(0)) ys.insert(unif(rng));
+// A set of n keys over [0, 4n), and one range(2) times smaller, half of
+// whose keys are in the larger one.
+static auto skewed_input(benchmark::State const& state) -> std::pair<std::vector<int>, std::vector<int>> {
+  auto rng = std::mt19937_64(state.range(0));
+  auto const n = int(state.range(0));
+  auto const m = n / int(state.range(2));
+  return workload::overlapping_keys(rng, workload::dist(state.range(1)), m, n, m / 2, 4 * int64_t{n});
+}
 
-    state.ResumeTiming();
-    auto z = benchunion::flatset_intersection_eh(xs, ys);
+struct merge_intersection {
+  template<typename S>
+  static auto run(S const& xs, S const& ys) { return benchunion::vectorset_intersection(xs, ys); }
+};
+
+struct galloping_intersection {
+  template<typename S>
+  static auto run(S const& xs, S const& ys) { return benchunion::vectorset_intersection_galloping(xs, ys); }
+};
+
+struct baeza_yates_intersection {
+  template<typename S>
+  static auto run(S const& xs, S const& ys) { return benchunion::vectorset_intersection_baeza_yates(xs, ys); }
+};
+
+struct adaptive_intersection {
+  template<typename S>
+  static auto run(S const& xs, S const& ys) { return benchunion::vectorset_intersection_adaptive(xs, ys); }
+};
+
+// The first argument is the size of the larger set, the third the ratio of
+// the sizes.
+template<typename Algorithm>
+static void BM_IntersectionSkewed(benchmark::State& state) {
+  auto const [xs, ys] = skewed_input(state);
+  while (state.KeepRunning()) {
+    auto z = Algorithm::run(xs, ys);
+    benchmark::DoNotOptimize(z.data());
   }
+  state.SetItemsProcessed(state.iterations() * xs.size());
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_IntersectionWithFlatSetEmplaceHint)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
 
-static void BM_IntersectionWithUSetInsert(benchmark::State& state) {
+static void BM_IntersectionSkewedFlatSet(benchmark::State& state) {
+  auto const [v, w] = skewed_input(state);
+  auto const xs = boost::container::flat_set<int>(boost::container::ordered_unique_range, v.begin(), v.end());
+  auto const ys = boost::container::flat_set<int>(boost::container::ordered_unique_range, w.begin(), w.end());
   while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = std::unordered_set<int>{};
-    auto ys = std::unordered_set<int>{};
+    auto z = benchunion::flatset_intersection_adaptive(xs, ys);
+    benchmark::DoNotOptimize(z.size());
+  }
+  state.SetItemsProcessed(state.iterations() * xs.size());
+  state.SetLabel(label(state));
+}
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
+static void skewed_args(benchmark::internal::Benchmark* b) {
+  for (auto d : workload::dists)
+    for (auto n : {100000, 10000000})
+      for (auto ratio : {1, 4, 16, 64, 256, 1000, 10000})
+        b->Args({n, int(d), ratio});
+}
 
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
-    while ((signed)ys.size() < state.range(0)) ys.insert(unif(rng));
+BENCHMARK_TEMPLATE(BM_IntersectionSkewed, merge_intersection)->Apply(skewed_args);
+BENCHMARK_TEMPLATE(BM_IntersectionSkewed, galloping_intersection)->Apply(skewed_args);
+BENCHMARK_TEMPLATE(BM_IntersectionSkewed, baeza_yates_intersection)->Apply(skewed_args);
+BENCHMARK_TEMPLATE(BM_IntersectionSkewed, adaptive_intersection)->Apply(skewed_args);
+BENCHMARK(BM_IntersectionSkewedFlatSet)->Apply(skewed_args);
 
-    state.ResumeTiming();
-    auto z = benchunion::stduset_intersection(xs, ys);
+static auto roaring_input(benchmark::State const& state, int64_t universe)
+    -> std::pair<benchunion::roaring_set, benchunion::roaring_set> {
+  auto const [xs, ys] = intersection_input<std::vector<int>>(state, universe);
+  auto rxs = benchunion::roaring_set{};
+  auto rys = benchunion::roaring_set{};
+  for (auto x : xs) rxs.insert(x);
+  for (auto y : ys) rys.insert(y);
+  return {std::move(rxs), std::move(rys)};
+}
+
+static void BM_IntersectionWithRoaring(benchmark::State& state) {
+  auto const [xs, ys] = roaring_input(state, workload::wide);
+  while (state.KeepRunning()) {
+    auto z = benchunion::roaringset_intersection(xs, ys);
+    benchmark::DoNotOptimize(z);
   }
+  state.SetLabel(label(state) + " bytes/elem: " + std::to_string(double(xs.bytes() + ys.bytes()) / (2 * state.range(0))));
 }
-BENCHMARK(BM_IntersectionWithUSetInsert)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_IntersectionWithRoaring)->Apply(intersection_args);
 
-static void BM_IntersectionWithVector(benchmark::State& state) {
+// Sets of n values from [0, 2n), run-optimized.
+static void BM_IntersectionWithRoaringDense(benchmark::State& state) {
+  auto [xs, ys] = roaring_input(state, 2 * state.range(0));
+  xs.run_optimize();
+  ys.run_optimize();
   while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = std::vector<int>{};
-    auto ys = std::vector<int>{};
+    auto z = benchunion::roaringset_intersection(xs, ys);
+    benchmark::DoNotOptimize(z);
+  }
+  state.SetLabel(label(state) + " bytes/elem: " + std::to_string(double(xs.bytes() + ys.bytes()) / (2 * state.range(0))));
+}
+BENCHMARK(BM_IntersectionWithRoaringDense)->Apply(intersection_args);
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
+// BM_IntersectionWithStdSetInsert and friends again, with the inputs and the result
+// allocated from an arena or a pool: the difference with the runs above is
+// the share of the allocator. As above, only the operation and the freeing
+// of its result are timed: the inputs and their memory, which cannot be
+// kept across iterations since an arena only grows, are freed without timing.
+template<typename Alloc>
+struct stdset_intersection_in {
+  using set = std::set<int, std::less<int>, Alloc>;
+  static auto insert(set& xs, int k) { xs.insert(k); }
+  static auto run(set const& xs, set const& ys) { return benchunion::stdset_intersection(xs, ys); }
+};
 
-    while ((signed)xs.size() < state.range(0)) benchunion::insert_unique(xs, unif(rng));
-    while ((signed)ys.size() < state.range(0)) benchunion::insert_unique(ys, unif(rng));
+template<typename Alloc>
+struct flatset_intersection_in {
+  using set = boost::container::flat_set<int, std::less<int>, Alloc>;
+  static auto insert(set& xs, int k) { xs.insert(k); }
+  static auto run(set const& xs, set const& ys) { return benchunion::flatset_intersection(xs, ys); }
+};
 
+template<typename Alloc>
+struct uset_intersection_in {
+  using set = std::unordered_set<int, std::hash<int>, std::equal_to<int>, Alloc>;
+  static auto insert(set& xs, int k) { xs.insert(k); }
+  static auto run(set const& xs, set const& ys) { return benchunion::stduset_intersection(xs, ys); }
+};
+
+template<typename Alloc>
+struct vector_intersection_in {
+  using set = std::vector<int, Alloc>;
+  static auto insert(set& xs, int k) { benchunion::insert_unique(xs, k); }
+  static auto run(set const& xs, set const& ys) { return benchunion::vectorset_intersection(xs, ys); }
+};
+
+template<typename Intersection>
+static void BM_IntersectionAllocator(benchmark::State& state) {
+  using set = typename Intersection::set;
+  using allocator = typename set::allocator_type;
+  auto const [xkeys, ykeys] = intersection_input<std::vector<int>>(state, workload::wide);
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    {
+      auto memory = typename allocator::resource_type{};
+      auto xs = set(allocator(memory));
+      auto ys = set(allocator(memory));
+      for (auto k : xkeys) Intersection::insert(xs, k);
+      for (auto k : ykeys) Intersection::insert(ys, k);
+
+      state.ResumeTiming();
+      {
+        auto z = Intersection::run(xs, ys);
+        benchmark::DoNotOptimize(z);
+      }
+      state.PauseTiming();
+    }
     state.ResumeTiming();
-    auto z = benchunion::vectorset_intersection(xs, ys);
   }
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_IntersectionWithVector)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
 
-static void BM_IntersectionWithVectorNoBack(benchmark::State& state) {
+using arena = benchunion::arena_allocator<int>;
+using pool = benchunion::pool_allocator<int>;
+BENCHMARK_TEMPLATE(BM_IntersectionAllocator, stdset_intersection_in<arena>)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionAllocator, stdset_intersection_in<pool>)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionAllocator, flatset_intersection_in<arena>)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionAllocator, uset_intersection_in<arena>)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionAllocator, uset_intersection_in<pool>)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionAllocator, vector_intersection_in<arena>)->Apply(intersection_args);
+
+// The intersection as a new container, into a buffer, only counted, and
+// kept in place in xs, for each kind of set. The inputs are those of the
+// kernels, built once per benchmark.
+
+struct stdset_intersection_forms {
+  using set = std::set<int>;
+  static auto fresh(set const& xs, set const& ys) { return benchunion::stdset_intersection(xs, ys); }
+  template<typename Out>
+  static auto into(set const& xs, set const& ys, Out out) { return benchunion::stdset_intersection_into(xs, ys, out); }
+  static auto size(set const& xs, set const& ys) { return benchunion::stdset_intersection_size(xs, ys); }
+  static auto inplace(set& xs, set const& ys) { benchunion::stdset_intersection_inplace(xs, ys); }
+};
+
+struct flatset_intersection_forms {
+  using set = boost::container::flat_set<int>;
+  static auto fresh(set const& xs, set const& ys) { return benchunion::flatset_intersection(xs, ys); }
+  template<typename Out>
+  static auto into(set const& xs, set const& ys, Out out) { return benchunion::flatset_intersection_into(xs, ys, out); }
+  static auto size(set const& xs, set const& ys) { return benchunion::flatset_intersection_size(xs, ys); }
+  static auto inplace(set& xs, set const& ys) { benchunion::flatset_intersection_inplace(xs, ys); }
+};
+
+struct uset_intersection_forms {
+  using set = std::unordered_set<int>;
+  static auto fresh(set const& xs, set const& ys) { return benchunion::stduset_intersection(xs, ys); }
+  template<typename Out>
+  static auto into(set const& xs, set const& ys, Out out) { return benchunion::stduset_intersection_into(xs, ys, out); }
+  static auto size(set const& xs, set const& ys) { return benchunion::stduset_intersection_size(xs, ys); }
+  static auto inplace(set& xs, set const& ys) { benchunion::stduset_intersection_inplace(xs, ys); }
+};
+
+struct vector_intersection_forms {
+  using set = std::vector<int>;
+  static auto fresh(set const& xs, set const& ys) { return benchunion::vectorset_intersection(xs, ys); }
+  template<typename Out>
+  static auto into(set const& xs, set const& ys, Out out) { return benchunion::vectorset_intersection_into(xs, ys, out); }
+  static auto size(set const& xs, set const& ys) { return benchunion::vectorset_intersection_size(xs, ys); }
+  static auto inplace(set& xs, set const& ys) { benchunion::vectorset_intersection_inplace(xs, ys); }
+};
+
+struct swiss_intersection_forms {
+  using set = benchunion::swiss_set<int>;
+  static auto fresh(set const& xs, set const& ys) { return benchunion::swissset_intersection(xs, ys); }
+  template<typename Out>
+  static auto into(set const& xs, set const& ys, Out out) { return benchunion::swissset_intersection_into(xs, ys, out); }
+  static auto size(set const& xs, set const& ys) { return benchunion::swissset_intersection_size(xs, ys); }
+  static auto inplace(set& xs, set const& ys) { benchunion::swissset_intersection_inplace(xs, ys); }
+};
+
+struct roaring_intersection_forms {
+  using set = benchunion::roaring_set;
+  static auto fresh(set const& xs, set const& ys) { return benchunion::roaringset_intersection(xs, ys); }
+  template<typename Out>
+  static auto into(set const& xs, set const& ys, Out out) { return benchunion::roaringset_intersection_into(xs, ys, out); }
+  static auto size(set const& xs, set const& ys) { return benchunion::roaringset_intersection_size(xs, ys); }
+  static auto inplace(set& xs, set const& ys) { benchunion::roaringset_intersection_inplace(xs, ys); }
+};
+
+struct myflat_intersection_forms {
+  using set = my::flat_set<int>;
+  static auto fresh(set const& xs, set const& ys) {
+    auto v = std::vector<int>{};
+    v.reserve(xs.size() + ys.size());
+    benchunion::sorted_intersection_into(xs.begin(), xs.end(), ys.begin(), ys.end(), std::back_inserter(v));
+    return set(my::ordered_unique_range, std::move(v));
+  }
+  template<typename Out>
+  static auto into(set const& xs, set const& ys, Out out) { return benchunion::sorted_intersection_into(xs.begin(), xs.end(), ys.begin(), ys.end(), out); }
+  static auto size(set const& xs, set const& ys) { return benchunion::sorted_intersection_size(xs.begin(), xs.end(), ys.begin(), ys.end()); }
+  static auto inplace(set& xs, set const& ys) { xs &= ys; }
+};
+
+template<typename Forms>
+static void BM_IntersectionNew(benchmark::State& state) {
+  auto const [xs, ys] = intersection_input<typename Forms::set>(state, 4 * state.range(0));
   while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = std::vector<int>{};
-    auto ys = std::vector<int>{};
+    auto z = Forms::fresh(xs, ys);
+    benchmark::DoNotOptimize(z.size());
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+  state.SetLabel(label(state));
+}
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
+// Into a buffer allocated once.
+template<typename Forms>
+static void BM_IntersectionInto(benchmark::State& state) {
+  auto const [xs, ys] = intersection_input<typename Forms::set>(state, 4 * state.range(0));
+  auto out = std::vector<int>(2 * state.range(0));
+  while (state.KeepRunning()) {
+    auto end = Forms::into(xs, ys, out.begin());
+    benchmark::DoNotOptimize(end);
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+  state.SetLabel(label(state));
+}
 
-    while ((signed)xs.size() < state.range(0)) benchunion::insert_unique_noback(xs, unif(rng));
-    while ((signed)ys.size() < state.range(0)) benchunion::insert_unique_noback(ys, unif(rng));
+template<typename Forms>
+static void BM_IntersectionSize(benchmark::State& state) {
+  auto const [xs, ys] = intersection_input<typename Forms::set>(state, 4 * state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(Forms::size(xs, ys));
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+  state.SetLabel(label(state));
+}
 
+// Into a copy of xs, made without timing.
+template<typename Forms>
+static void BM_IntersectionInPlace(benchmark::State& state) {
+  auto const [xs, ys] = intersection_input<typename Forms::set>(state, 4 * state.range(0));
+  auto zs = typename Forms::set{};
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    zs = xs;
     state.ResumeTiming();
-    auto z = benchunion::vectorset_intersection_noback(xs, ys);
+    Forms::inplace(zs, ys);
   }
+  state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_IntersectionWithVectorNoBack)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+
+BENCHMARK_TEMPLATE(BM_IntersectionNew, stdset_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionNew, flatset_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionNew, uset_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionNew, vector_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionNew, myflat_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionNew, swiss_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionNew, roaring_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionInto, stdset_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionInto, flatset_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionInto, uset_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionInto, vector_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionInto, myflat_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionInto, swiss_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionInto, roaring_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionSize, stdset_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionSize, flatset_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionSize, uset_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionSize, vector_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionSize, myflat_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionSize, swiss_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionSize, roaring_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionInPlace, stdset_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionInPlace, flatset_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionInPlace, uset_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionInPlace, vector_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionInPlace, myflat_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionInPlace, swiss_intersection_forms)->Apply(intersection_args);
+BENCHMARK_TEMPLATE(BM_IntersectionInPlace, roaring_intersection_forms)->Apply(intersection_args);
@@ -0,0 +1,83 @@
+#include "benchmark/benchmark.h"
+#include "benchset/myflat.hh"
+#include "benchset/buffered_flat.hh"
+#include "benchset/swiss_set.hh"
+#include "workload.hh"
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+#include <unordered_set>
+#include <boost/container/flat_set.hpp>
+
+// Inserts and finds interleaved on a set of n keys from [0, 4n), of the
+// distribution of the second argument, with the third the percentage of
+// inserts. A quarter of the finds hit, and the inserts are of keys next to
+// the set's, as workload::queries misses. The operations are drawn before
+// timing and replayed in a loop. The set grows with the inserts: it is
+// rebuilt, without timing, whenever it has grown by a quarter.
+template<typename Set>
+static auto contains(Set const& xs, int k) -> bool { return xs.find(k) != xs.end(); }
+
+static auto contains(my::buffered_flat_set<int> const& xs, int k) -> bool { return xs.contains(k); }
+
+constexpr auto mixed_ops = 1000;
+
+struct mixed_op {
+  bool insert;
+  int key;
+};
+
+static auto mixed_input(benchmark::State const& state) -> std::pair<std::vector<int>, std::vector<mixed_op>> {
+  auto const n = int(state.range(0));
+  auto const d = workload::dist(state.range(1));
+  auto rng = std::mt19937_64(n);
+  auto const sorted = workload::sorted_keys(rng, d, n, 4 * int64_t{n});
+  constexpr auto count = size_t{1} << 16;
+  auto const finds = workload::queries(rng, d, sorted, count, 0.25);
+  auto const inserts = workload::queries(rng, d, sorted, count, 0.0);
+  auto percent = std::uniform_int_distribution<int>(0, 99);
+  auto ops = std::vector<mixed_op>(count);
+  for (auto i = size_t{0}; i < count; ++i) {
+    auto const insert = percent(rng) < state.range(2);
+    ops[i] = {insert, insert? inserts[i] : finds[i]};
+  }
+  return {workload::insertion_order(rng, d, sorted), std::move(ops)};
+}
+
+template<typename Set>
+static void BM_Mixed(benchmark::State& state) {
+  auto const [keys, ops] = mixed_input(state);
+
+  auto xs = Set(keys.begin(), keys.end());
+  auto const limit = xs.size() + xs.size() / 4;
+  auto next = size_t{0};
+  while (state.KeepRunning()) {
+    for (auto i = 0; i < mixed_ops; ++i) {
+      auto const& op = ops[next++ & (ops.size() - 1)];
+      if (op.insert) xs.insert(op.key);
+      else benchmark::DoNotOptimize(contains(xs, op.key));
+    }
+    if (xs.size() > limit) {
+      state.PauseTiming();
+      xs = Set(keys.begin(), keys.end());
+      state.ResumeTiming();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * mixed_ops);
+  state.SetLabel(workload::name(workload::dist(state.range(1))));
+}
+
+static void mixed_args(benchmark::internal::Benchmark* b) {
+  for (auto d : workload::dists)
+    for (auto n : {10000, 1000000})
+      for (auto writes : {1, 10, 50, 90})
+        b->Args({n, int(d), writes});
+}
+
+BENCHMARK_TEMPLATE(BM_Mixed, std::set<int>)->Apply(mixed_args);
+BENCHMARK_TEMPLATE(BM_Mixed, boost::container::flat_set<int>)->Apply(mixed_args);
+BENCHMARK_TEMPLATE(BM_Mixed, my::flat_set<int>)->Apply(mixed_args);
+BENCHMARK_TEMPLATE(BM_Mixed, my::buffered_flat_set<int>)->Apply(mixed_args);
+BENCHMARK_TEMPLATE(BM_Mixed, std::unordered_set<int>)->Apply(mixed_args);
+BENCHMARK_TEMPLATE(BM_Mixed, benchunion::swiss_set<int>)->Apply(mixed_args);
@@ -0,0 +1,78 @@
+#include "benchmark/benchmark.h"
+#include "benchset/multiway.hh"
+#include "benchset/union.hh"
+#include "benchset/intersection.hh"
+#include "workload.hh"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// k posting lists of about n document ids each, over about [0, k * n), of
+// the distribution of the third argument: n ids of it each, and n / 40 more
+// shared by every list, so that the intersection is not empty.
+static auto posting_lists(benchmark::State const& state) -> std::vector<std::vector<int>> {
+  auto const k = int(state.range(0)), n = int(state.range(1));
+  auto const d = workload::dist(state.range(2));
+  auto const universe = int64_t{k} * n;
+  auto rng = std::mt19937_64(universe);
+  auto const shared = workload::sorted_keys(rng, d, n / 40, universe);
+  auto lists = std::vector<std::vector<int>>(k);
+  for (auto& l : lists) {
+    auto const own = workload::sorted_keys(rng, d, n, universe);
+    std::set_union(own.begin(), own.end(), shared.begin(), shared.end(), std::back_inserter(l));
+  }
+  return lists;
+}
+
+static void multiway_args(benchmark::internal::Benchmark* b) {
+  for (auto d : workload::dists)
+    b->Args({10, 10000, int(d)})->Args({100, 10000, int(d)})->Args({1000, 1000, int(d)});
+}
+
+static auto label(benchmark::State& state) -> void {
+  state.SetLabel(workload::name(workload::dist(state.range(2))));
+}
+
+static void BM_UnionPairwise(benchmark::State& state) {
+  auto const lists = posting_lists(state);
+  while (state.KeepRunning()) {
+    auto u = lists[0];
+    for (auto i = size_t{1}; i < lists.size(); ++i) u = benchunion::sorted_vector_union(u, lists[i]);
+    benchmark::DoNotOptimize(u.data());
+  }
+  label(state);
+}
+BENCHMARK(BM_UnionPairwise)->Apply(multiway_args);
+
+static void BM_UnionLoserTree(benchmark::State& state) {
+  auto const lists = posting_lists(state);
+  auto u = std::vector<int>{};
+  while (state.KeepRunning()) {
+    benchunion::vectorset_union_into(lists, u);
+    benchmark::DoNotOptimize(u.data());
+  }
+  label(state);
+}
+BENCHMARK(BM_UnionLoserTree)->Apply(multiway_args);
+
+static void BM_IntersectionPairwise(benchmark::State& state) {
+  auto const lists = posting_lists(state);
+  while (state.KeepRunning()) {
+    auto inter = lists[0];
+    for (auto i = size_t{1}; i < lists.size(); ++i) inter = benchunion::vectorset_intersection(inter, lists[i]);
+    benchmark::DoNotOptimize(inter.data());
+  }
+  label(state);
+}
+BENCHMARK(BM_IntersectionPairwise)->Apply(multiway_args);
+
+static void BM_IntersectionSmallestFirst(benchmark::State& state) {
+  auto const lists = posting_lists(state);
+  auto inter = std::vector<int>{};
+  while (state.KeepRunning()) {
+    benchunion::vectorset_intersection_into(lists, inter);
+    benchmark::DoNotOptimize(inter.data());
+  }
+  label(state);
+}
+BENCHMARK(BM_IntersectionSmallestFirst)->Apply(multiway_args);
@@ -0,0 +1,149 @@
+#include "benchmark/benchmark.h"
+#include "benchset/packed_set.hh"
+#include "benchset/roaring.hh"
+#include "benchset/simd_intersection.hh"
+#include "benchset/union.hh"
+#include "workload.hh"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Sorted sets of n integers from [0, g n), of the distribution of the
+// second argument, g the third: the gaps average g, so the bits a packed
+// element needs grow with log g, more for uniform keys than for clustered
+// ones with the same average. Each benchmark reports the bytes per element
+// of its sets.
+static auto universe(benchmark::State const& state) -> int64_t {
+  return int64_t{state.range(0)} * state.range(2);
+}
+
+static auto packed_input(benchmark::State const& state) -> std::vector<int> {
+  auto rng = std::mt19937_64(state.range(0));
+  return workload::sorted_keys(rng, workload::dist(state.range(1)), state.range(0), universe(state));
+}
+
+// Two of them sharing a quarter of their values, for the set operations.
+static auto packed_pair(benchmark::State const& state) -> std::pair<std::vector<int>, std::vector<int>> {
+  auto rng = std::mt19937_64(state.range(0));
+  return workload::overlapping_keys(rng, workload::dist(state.range(1)), state.range(0), 25, universe(state));
+}
+
+struct raw_vector {
+  using set = std::vector<int>;
+  static auto make(std::vector<int> const& xs) -> set { return xs; }
+  static auto bytes(set const& xs) -> size_t { return sizeof(xs) + xs.capacity() * sizeof(int); }
+  static auto contains(set const& xs, int x) -> bool { return std::binary_search(xs.begin(), xs.end(), x); }
+  static auto sum(set const& xs) -> int64_t {
+    auto s = int64_t{0};
+    for (auto x : xs) s += x;
+    return s;
+  }
+  static auto unite(set const& xs, set const& ys) { return benchunion::vectorset_union(xs, ys); }
+  static auto intersect(set const& xs, set const& ys) { return benchunion::vectorset_intersection_simd(xs, ys); }
+};
+
+struct packed {
+  using set = benchunion::packed_set<int>;
+  static auto make(std::vector<int> const& xs) -> set { return set(xs.begin(), xs.end()); }
+  static auto bytes(set const& xs) -> size_t { return xs.bytes(); }
+  static auto contains(set const& xs, int x) -> bool { return xs.contains(x); }
+  static auto sum(set const& xs) -> int64_t {
+    auto s = int64_t{0};
+    xs.for_each([&s](int x) { s += x; });
+    return s;
+  }
+  static auto unite(set const& xs, set const& ys) { return benchunion::packedset_union(xs, ys); }
+  static auto intersect(set const& xs, set const& ys) { return benchunion::packedset_intersection(xs, ys); }
+};
+
+struct roaring {
+  using set = benchunion::roaring_set;
+  static auto make(std::vector<int> const& xs) -> set {
+    auto s = set{};
+    for (auto x : xs) s.insert(uint32_t(x));
+    s.run_optimize();
+    return s;
+  }
+  static auto bytes(set const& xs) -> size_t { return xs.bytes(); }
+  static auto contains(set const& xs, int x) -> bool { return xs.contains(uint32_t(x)); }
+  static auto sum(set const& xs) -> int64_t {
+    auto s = int64_t{0};
+    xs.for_each([&s](uint32_t x) { s += x; });
+    return s;
+  }
+  static auto unite(set const& xs, set const& ys) { return benchunion::roaringset_union(xs, ys); }
+  static auto intersect(set const& xs, set const& ys) { return benchunion::roaringset_intersection(xs, ys); }
+};
+
+template<typename Repr>
+static auto label(benchmark::State& state, typename Repr::set const& xs, size_t n) -> void {
+  state.SetLabel(std::string(workload::name(workload::dist(state.range(1)))) +
+                 " bytes/elem: " + std::to_string(double(Repr::bytes(xs)) / n));
+}
+
+template<typename Repr>
+static void BM_PackedFind(benchmark::State& state) {
+  auto const keys = packed_input(state);
+  auto const xs = Repr::make(keys);
+  auto rng = std::mt19937_64(state.range(0) + 1);
+  auto const queries = workload::queries(rng, workload::dist(state.range(1)), keys, 1000);
+  while (state.KeepRunning())
+    for (auto q : queries) benchmark::DoNotOptimize(Repr::contains(xs, q));
+  state.SetItemsProcessed(state.iterations() * queries.size());
+  label<Repr>(state, xs, keys.size());
+}
+
+template<typename Repr>
+static void BM_PackedScan(benchmark::State& state) {
+  auto const keys = packed_input(state);
+  auto const xs = Repr::make(keys);
+  while (state.KeepRunning()) benchmark::DoNotOptimize(Repr::sum(xs));
+  state.SetItemsProcessed(state.iterations() * keys.size());
+  label<Repr>(state, xs, keys.size());
+}
+
+template<typename Repr>
+static void BM_PackedUnion(benchmark::State& state) {
+  auto const [xkeys, ykeys] = packed_pair(state);
+  auto const xs = Repr::make(xkeys);
+  auto const ys = Repr::make(ykeys);
+  while (state.KeepRunning()) {
+    auto z = Repr::unite(xs, ys);
+    benchmark::DoNotOptimize(z);
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+  label<Repr>(state, xs, size_t(state.range(0)));
+}
+
+template<typename Repr>
+static void BM_PackedIntersection(benchmark::State& state) {
+  auto const [xkeys, ykeys] = packed_pair(state);
+  auto const xs = Repr::make(xkeys);
+  auto const ys = Repr::make(ykeys);
+  while (state.KeepRunning()) {
+    auto z = Repr::intersect(xs, ys);
+    benchmark::DoNotOptimize(z);
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+  label<Repr>(state, xs, size_t(state.range(0)));
+}
+
+// Gaps of up to 1024, for 10^6 keys to stay within workload::wide.
+static void packed_args(benchmark::internal::Benchmark* b) {
+  for (auto d : workload::dists)
+    for (auto g : {2, 64, 1024})
+      for (auto n : {10000, 1000000})
+        b->Args({n, int(d), g});
+}
+
+#define PACKED_BENCHMARKS(bm)                          \
+  BENCHMARK_TEMPLATE(bm, raw_vector)->Apply(packed_args); \
+  BENCHMARK_TEMPLATE(bm, packed)->Apply(packed_args);     \
+  BENCHMARK_TEMPLATE(bm, roaring)->Apply(packed_args)
+
+PACKED_BENCHMARKS(BM_PackedFind);
+PACKED_BENCHMARKS(BM_PackedScan);
+PACKED_BENCHMARKS(BM_PackedUnion);
+PACKED_BENCHMARKS(BM_PackedIntersection);
@@ -0,0 +1,89 @@
+#include "benchmark/benchmark.h"
+#include "benchset/union.hh"
+#include "benchset/intersection.hh"
+#include "benchset/par_setops.hh"
+#include "workload.hh"
+#include <random>
+#include <utility>
+#include <vector>
+
+// Two sorted sets of n values from [0, 4n), of the distribution of the
+// second argument, sharing a quarter of their values. Only sequential ones,
+// built in linear time, go up to 10^8 values.
+static auto large_input(benchmark::State const& state) -> std::pair<std::vector<int>, std::vector<int>> {
+  auto const n = int(state.range(0));
+  auto rng = std::mt19937_64(n);
+  return workload::overlapping_keys(rng, workload::dist(state.range(1)), n, 25, 4 * int64_t{n});
+}
+
+static auto large_sizes(workload::dist d) -> std::vector<int> {
+  if (d == workload::dist::sequential) return {10000000, 100000000};
+  return {10000000};
+}
+
+static void serial_args(benchmark::internal::Benchmark* b) {
+  for (auto d : workload::dists)
+    for (auto n : large_sizes(d)) b->Args({n, int(d)});
+}
+
+static void parallel_args(benchmark::internal::Benchmark* b) {
+  for (auto d : workload::dists)
+    for (auto n : large_sizes(d))
+      for (auto threads : {1, 2, 4, 8}) b->Args({n, int(d), threads});
+}
+
+static auto label(benchmark::State& state) -> void {
+  state.SetLabel(workload::name(workload::dist(state.range(1))));
+}
+
+static void BM_UnionSerialLarge(benchmark::State& state) {
+  auto const [xs, ys] = large_input(state);
+  while (state.KeepRunning()) {
+    auto z = benchunion::vectorset_union(xs, ys);
+    benchmark::DoNotOptimize(z.data());
+  }
+  state.SetBytesProcessed(state.iterations() * 2 * state.range(0) * sizeof(int));
+  label(state);
+}
+BENCHMARK(BM_UnionSerialLarge)->Apply(serial_args)->UseRealTime();
+
+// The third argument is the size of the pool. The pool's threads are the
+// ones doing the work, so this replaces the harness's ThreadRange(), as in
+// expr_par.cc. The output is reused: allocating and zeroing it would be
+// serial.
+static void BM_UnionParallel(benchmark::State& state) {
+  auto const [xs, ys] = large_input(state);
+  auto pool = par::pool(state.range(2));
+  auto z = std::vector<int>{};
+  while (state.KeepRunning()) {
+    benchunion::vectorset_union_parallel_into(pool, xs, ys, z);
+    benchmark::DoNotOptimize(z.data());
+  }
+  state.SetBytesProcessed(state.iterations() * 2 * state.range(0) * sizeof(int));
+  label(state);
+}
+BENCHMARK(BM_UnionParallel)->Apply(parallel_args)->UseRealTime();
+
+static void BM_IntersectionSerialLarge(benchmark::State& state) {
+  auto const [xs, ys] = large_input(state);
+  while (state.KeepRunning()) {
+    auto z = benchunion::vectorset_intersection(xs, ys);
+    benchmark::DoNotOptimize(z.data());
+  }
+  state.SetBytesProcessed(state.iterations() * 2 * state.range(0) * sizeof(int));
+  label(state);
+}
+BENCHMARK(BM_IntersectionSerialLarge)->Apply(serial_args)->UseRealTime();
+
+static void BM_IntersectionParallel(benchmark::State& state) {
+  auto const [xs, ys] = large_input(state);
+  auto pool = par::pool(state.range(2));
+  auto z = std::vector<int>{};
+  while (state.KeepRunning()) {
+    benchunion::vectorset_intersection_parallel_into(pool, xs, ys, z);
+    benchmark::DoNotOptimize(z.data());
+  }
+  state.SetBytesProcessed(state.iterations() * 2 * state.range(0) * sizeof(int));
+  label(state);
+}
+BENCHMARK(BM_IntersectionParallel)->Apply(parallel_args)->UseRealTime();
@@ -0,0 +1,104 @@
+#include "benchmark/benchmark.h"
+#include "benchset/myflat.hh"
+#include "benchset/snapshot_set.hh"
+#include "workload.hh"
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <type_traits>
+#include <vector>
+
+// Finds from every thread in one shared set of n keys from [0, 2n), of the
+// distribution of the second argument, while thread 0 also writes: one
+// insert or erase, alternately, every 'write_every' operations. The keys
+// looked up, inserted and erased are drawn before timing, as
+// workload::queries, half of them in the initial set.
+template<typename Mutex>
+class locked_flat_set {
+ public:
+  explicit locked_flat_set(my::flat_set<int> keys) : m_keys(std::move(keys)) {}
+
+  // The lock is the whole protocol: readers need no state of their own.
+  auto make_reader() const -> locked_flat_set const& { return *this; }
+
+  auto contains(int k) const -> bool {
+    if constexpr (std::is_same_v<Mutex, std::shared_mutex>) {
+      std::shared_lock<Mutex> lk(m_lock);
+      return m_keys.find(k) != m_keys.end();
+    } else {
+      std::lock_guard<Mutex> lk(m_lock);
+      return m_keys.find(k) != m_keys.end();
+    }
+  }
+
+  auto insert(int k) -> void {
+    std::lock_guard<Mutex> lk(m_lock);
+    m_keys.insert(k);
+  }
+
+  auto erase(int k) -> void {
+    std::lock_guard<Mutex> lk(m_lock);
+    m_keys.erase(k);
+  }
+
+ private:
+  my::flat_set<int> m_keys;
+  mutable Mutex m_lock;
+};
+
+// Published every 64 writes: readers see a write after at most 6400 finds.
+struct snapshot_flat_set : my::snapshot_set<int> {
+  explicit snapshot_flat_set(my::flat_set<int> keys) : my::snapshot_set<int>(std::move(keys), 64) {}
+};
+
+constexpr auto snapshot_ops = 1000;
+constexpr auto write_every = 100;
+
+static void snapshot_args(benchmark::internal::Benchmark* b) {
+  for (auto d : workload::dists) b->Args({100000, int(d)});
+}
+
+// Each thread takes its reader once, as a reader thread of the set would,
+// after the first KeepRunning: it waits for thread 0 to have built the set.
+// The threads share the set, so that thread 0 does not free it under the
+// readers of the others once done.
+template<typename Set>
+static void BM_ConcurrentFind(benchmark::State& state) {
+  static std::shared_ptr<Set> shared;
+  auto const n = state.range(0);
+  auto const d = workload::dist(state.range(1));
+  auto rng = std::mt19937_64(n);
+  auto const keys = workload::sorted_keys(rng, d, n, 2 * n);
+  if (state.thread_index == 0)
+    shared = std::make_shared<Set>(my::flat_set<int>(my::ordered_unique_range, keys));
+
+  rng.seed(n + 1 + state.thread_index);
+  auto const qs = workload::queries(rng, d, keys, size_t{1} << 16);
+  auto next = size_t{0};
+  auto writes = int64_t{0};
+  auto running = state.KeepRunning();
+  auto const xs = shared;
+  auto const& r = xs->make_reader();
+  for (; running; running = state.KeepRunning()) {
+    for (auto i = 0; i < snapshot_ops; ++i) {
+      if (state.thread_index == 0 && i % write_every == 0) {
+        auto const k = qs[next++ & (qs.size() - 1)];
+        if (++writes % 2) xs->insert(k);
+        else xs->erase(k);
+      } else {
+        benchmark::DoNotOptimize(r.contains(qs[next++ & (qs.size() - 1)]));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * snapshot_ops);
+  state.SetLabel(workload::name(d));
+
+  if (state.thread_index == 0) shared.reset();
+}
+BENCHMARK_TEMPLATE(BM_ConcurrentFind, locked_flat_set<std::mutex>)
+    ->Apply(snapshot_args)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ConcurrentFind, locked_flat_set<std::shared_mutex>)
+    ->Apply(snapshot_args)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ConcurrentFind, snapshot_flat_set)
+    ->Apply(snapshot_args)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,79 @@
+#include "benchmark/benchmark.h"
+#include "benchset/myflat.hh"
+#include "benchset/string_flat_map.hh"
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Finds of string keys, given as std::string_view, in maps of n keys. The
+// second argument is the shape of the keys: 0 for random words of 4 to 16
+// letters, 1 for URLs sharing a 25 byte prefix, so that only the end of a key
+// tells it apart. Half the queries hit.
+static auto string_keys(size_t n, int shape, std::mt19937_64& rng) -> std::vector<std::string> {
+  auto letter = std::uniform_int_distribution<int>('a', 'z');
+  auto length = std::uniform_int_distribution<int>(4, 16);
+  auto id = std::uniform_int_distribution<uint64_t>(0, 1000000000);
+  auto keys = std::vector<std::string>(n);
+  for (auto& k : keys) {
+    if (shape == 0) {
+      k.resize(size_t(length(rng)));
+      for (auto& c : k) c = char(letter(rng));
+    } else {
+      k = "https://example.com/item/" + std::to_string(id(rng));
+    }
+  }
+  return keys;
+}
+
+// std::unordered_map has no heterogeneous lookup before C++20: the query
+// becomes a std::string, as it would in the code calling it.
+template<typename Map>
+static auto contains(Map const& m, std::string_view k) -> bool { return m.find(k) != m.end(); }
+
+static auto contains(std::unordered_map<std::string, int> const& m, std::string_view k) -> bool {
+  return m.find(std::string(k)) != m.end();
+}
+
+// my::flat_map looking up a std::string made from the query, as before
+// heterogeneous lookup.
+struct flat_map_string_keyed : my::flat_map<std::string, int> {
+  using my::flat_map<std::string, int>::flat_map;
+};
+
+static auto contains(flat_map_string_keyed const& m, std::string_view k) -> bool {
+  return m.find(std::string(k)) != m.end();
+}
+
+template<typename Map>
+static void BM_FindString(benchmark::State& state) {
+  auto const n = size_t(state.range(0));
+  auto rng = std::mt19937_64(n);
+  auto keys = string_keys(2 * n, int(state.range(1)), rng);
+  auto ps = std::vector<std::pair<std::string, int>>{};
+  for (auto i = size_t{0}; i < n; ++i) ps.emplace_back(keys[i], int(i));
+  auto const xs = Map(ps.begin(), ps.end());
+
+  // Every other query is one of the keys, the others mostly are not.
+  auto queries = std::vector<std::string_view>{};
+  auto pick = std::uniform_int_distribution<size_t>(0, n - 1);
+  for (auto i = size_t{0}; i < n; ++i) queries.push_back(keys[pick(rng) + (i % 2) * n]);
+
+  while (state.KeepRunning())
+    for (auto q : queries) benchmark::DoNotOptimize(contains(xs, q));
+  state.SetItemsProcessed(state.iterations() * int64_t(n));
+}
+
+static void string_args(benchmark::internal::Benchmark* b) {
+  for (auto shape : {0, 1})
+    for (auto n : {1000, 10000, 100000, 1000000})
+      b->Args({n, shape});
+}
+
+BENCHMARK_TEMPLATE(BM_FindString, std::map<std::string, int, std::less<>>)->Apply(string_args);
+BENCHMARK_TEMPLATE(BM_FindString, std::unordered_map<std::string, int>)->Apply(string_args);
+BENCHMARK_TEMPLATE(BM_FindString, flat_map_string_keyed)->Apply(string_args);
+BENCHMARK_TEMPLATE(BM_FindString, my::flat_map<std::string, int>)->Apply(string_args);
+BENCHMARK_TEMPLATE(BM_FindString, my::string_flat_map<int>)->Apply(string_args);
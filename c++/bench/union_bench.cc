@@ -1,158 +1,443 @@
 #include "benchmark/benchmark.h"
 #include "benchset/union.hh"
+#include "benchset/simd_union.hh"
+#include "benchset/roaring.hh"
+#include "benchset/swiss_set.hh"
+#include "benchset/arena.hh"
+#include "benchset/myflat.hh"
+#include "workload.hh"
+#include <iterator>
 #include <random>
+#include <string>
+#include <type_traits>
 
-static void BM_UnionWithStdSetInsert(benchmark::State& state) {
-  while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = std::set<int>{};
-    auto ys = std::set<int>{};
+// Two sets of n keys of the distribution range(1) of workload.hh, range(2)
+// % of them in both, built once per benchmark. Sorted vectors are taken as
+// they are; the other sets are filled in insertion order, so that the
+// nodes of std::set lie as random inserts leave them.
+template<typename Set>
+static auto union_input(benchmark::State const& state, int64_t universe) -> std::pair<Set, Set> {
+  auto rng = std::mt19937_64(state.range(0));
+  auto const d = workload::dist(state.range(1));
+  auto [xs, ys] = workload::overlapping_keys(rng, d, state.range(0), state.range(2), universe);
+  if constexpr (std::is_same_v<Set, std::vector<int>>) {
+    return {std::move(xs), std::move(ys)};
+  } else {
+    auto const fill = [&](std::vector<int> const& keys) {
+      auto const order = workload::insertion_order(rng, d, keys);
+      return Set(order.begin(), order.end());
+    };
+    return {fill(xs), fill(ys)};
+  }
+}
+
+// Sizes and distributions, the sets sharing a quarter of their keys.
+static void union_args(benchmark::internal::Benchmark* b) {
+  for (auto d : workload::dists)
+    for (auto n : {100, 1000, 10000, 100000})
+      b->Args({n, int(d), 25});
+}
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
+// And none to all of them, for n = 10^5.
+static void overlap_args(benchmark::internal::Benchmark* b) {
+  union_args(b);
+  for (auto d : workload::dists)
+    for (auto percent : {0, 50, 100})
+      b->Args({100000, int(d), percent});
+}
 
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
-    while ((signed)ys.size() < state.range(0)) ys.insert(unif(rng));
+static auto label(benchmark::State& state) -> std::string {
+  return workload::name(workload::dist(state.range(1)));
+}
 
-    state.ResumeTiming();
+static void BM_UnionWithStdSetInsert(benchmark::State& state) {
+  auto const [xs, ys] = union_input<std::set<int>>(state, workload::wide);
+  while (state.KeepRunning()) {
     auto z = benchunion::stdset_union(xs, ys);
+    benchmark::DoNotOptimize(z.size());
   }
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_UnionWithStdSetInsert)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_UnionWithStdSetInsert)->Apply(union_args);
 
 static void BM_UnionWithStdSetEmplaceHint(benchmark::State& state) {
+  auto const [xs, ys] = union_input<std::set<int>>(state, workload::wide);
   while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = std::set<int>{};
-    auto ys = std::set<int>{};
-
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
-
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
-    while ((signed)ys.size() < state.range(0)) ys.insert(unif(rng));
-
-    state.ResumeTiming();
     auto z = benchunion::stdset_union_eh(xs, ys);
+    benchmark::DoNotOptimize(z.size());
   }
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_UnionWithStdSetEmplaceHint)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_UnionWithStdSetEmplaceHint)->Apply(union_args);
 
 static void BM_UnionWithFlatSetInsert(benchmark::State& state) {
+  auto const [xs, ys] = union_input<boost::container::flat_set<int>>(state, workload::wide);
   while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = boost::container::flat_set<int>{};
-    auto ys = boost::container::flat_set<int>{};
-
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
-
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
-    while ((signed)ys.size() < state.range(0)) ys.insert(unif(rng));
-
-    state.ResumeTiming();
     auto z = benchunion::flatset_union(xs, ys);
+    benchmark::DoNotOptimize(z.size());
   }
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_UnionWithFlatSetInsert)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_UnionWithFlatSetInsert)->Apply(union_args);
 
 static void BM_UnionWithFlatSetEmplaceHint(benchmark::State& state) {
+  auto const [xs, ys] = union_input<boost::container::flat_set<int>>(state, workload::wide);
   while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = boost::container::flat_set<int>{};
-    auto ys = boost::container::flat_set<int>{};
+    auto z = benchunion::flatset_union_eh(xs, ys);
+    benchmark::DoNotOptimize(z.size());
+  }
+  state.SetLabel(label(state));
+}
+BENCHMARK(BM_UnionWithFlatSetEmplaceHint)->Apply(union_args);
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
+static void BM_UnionWithUSetInsert(benchmark::State& state) {
+  auto const [xs, ys] = union_input<std::unordered_set<int>>(state, workload::wide);
+  while (state.KeepRunning()) {
+    auto z = benchunion::stduset_union(xs, ys);
+    benchmark::DoNotOptimize(z.size());
+  }
+  state.SetLabel(label(state));
+}
+BENCHMARK(BM_UnionWithUSetInsert)->Apply(union_args);
 
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
-    while ((signed)ys.size() < state.range(0)) ys.insert(unif(rng));
+static void BM_UnionWithSwissSet(benchmark::State& state) {
+  auto const [xs, ys] = union_input<benchunion::swiss_set<int>>(state, workload::wide);
+  while (state.KeepRunning()) {
+    auto z = benchunion::swissset_union(xs, ys);
+    benchmark::DoNotOptimize(z.size());
+  }
+  state.SetLabel(label(state));
+}
+BENCHMARK(BM_UnionWithSwissSet)->Apply(union_args);
 
-    state.ResumeTiming();
-    auto z = benchunion::flatset_union_eh(xs, ys);
+static void BM_UnionWithVector(benchmark::State& state) {
+  auto const [xs, ys] = union_input<std::vector<int>>(state, workload::wide);
+  while (state.KeepRunning()) {
+    auto z = benchunion::vectorset_union(xs, ys);
+    benchmark::DoNotOptimize(z.size());
   }
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_UnionWithFlatSetEmplaceHint)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
+BENCHMARK(BM_UnionWithVector)->Apply(union_args);
 
-static void BM_UnionWithUSetInsert(benchmark::State& state) {
+static void BM_UnionWithVectorNoBack(benchmark::State& state) {
+  auto const [xs, ys] = union_input<std::vector<int>>(state, workload::wide);
   while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = std::unordered_set<int>{};
-    auto ys = std::unordered_set<int>{};
+    auto z = benchunion::vectorset_union_noback(xs, ys);
+    benchmark::DoNotOptimize(z.size());
+  }
+  state.SetLabel(label(state));
+}
+BENCHMARK(BM_UnionWithVectorNoBack)->Apply(union_args);
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
+// The vector variants, and the unions of benchset/simd_union.hh, on sets
+// over [0, 4n), also with none to all of their keys in common.
+struct vector_union {
+  static auto run(std::vector<int> const& xs, std::vector<int> const& ys) { return benchunion::vectorset_union(xs, ys); }
+};
 
-    while ((signed)xs.size() < state.range(0)) xs.insert(unif(rng));
-    while ((signed)ys.size() < state.range(0)) ys.insert(unif(rng));
+struct vector_union_noback {
+  static auto run(std::vector<int> const& xs, std::vector<int> const& ys) { return benchunion::vectorset_union_noback(xs, ys); }
+};
 
-    state.ResumeTiming();
-    auto z = benchunion::stduset_union(xs, ys);
+struct sorted_vector_union {
+  static auto run(std::vector<int> const& xs, std::vector<int> const& ys) { return benchunion::sorted_vector_union(xs, ys); }
+};
+
+struct branchless_union {
+  static auto run(std::vector<int> const& xs, std::vector<int> const& ys) { return benchunion::vectorset_union_branchless(xs, ys); }
+};
+
+template<benchunion::simd::isa I>
+struct simd_union {
+  static auto run(std::vector<int> const& xs, std::vector<int> const& ys) { return benchunion::vectorset_union_simd(xs, ys, I); }
+};
+
+// Only the SIMD unions depend on the CPU.
+template<typename Algorithm>
+static auto supported() { return true; }
+
+template<>
+auto supported<simd_union<benchunion::simd::isa::sse42>>() { return benchunion::simd::supported(benchunion::simd::isa::sse42); }
+
+template<>
+auto supported<simd_union<benchunion::simd::isa::avx2>>() { return benchunion::simd::supported(benchunion::simd::isa::avx2); }
+
+struct union_size {
+  static auto run(std::vector<int> const& xs, std::vector<int> const& ys) { return benchunion::vectorset_union_size(xs, ys); }
+};
+
+template<typename Algorithm>
+static void BM_UnionOfVectors(benchmark::State& state) {
+  if (!supported<Algorithm>()) {
+    state.SkipWithError("not supported by this CPU");
+    return;
   }
+  auto const [xs, ys] = union_input<std::vector<int>>(state, 4 * state.range(0));
+  while (state.KeepRunning()) {
+    auto z = Algorithm::run(xs, ys);
+    benchmark::DoNotOptimize(z);
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_UnionWithUSetInsert)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
 
-static void BM_UnionWithVector(benchmark::State& state) {
+using isa = benchunion::simd::isa;
+BENCHMARK_TEMPLATE(BM_UnionOfVectors, vector_union)->Apply(overlap_args);
+BENCHMARK_TEMPLATE(BM_UnionOfVectors, vector_union_noback)->Apply(overlap_args);
+BENCHMARK_TEMPLATE(BM_UnionOfVectors, sorted_vector_union)->Apply(overlap_args);
+BENCHMARK_TEMPLATE(BM_UnionOfVectors, branchless_union)->Apply(overlap_args);
+BENCHMARK_TEMPLATE(BM_UnionOfVectors, simd_union<isa::sse42>)->Apply(overlap_args);
+BENCHMARK_TEMPLATE(BM_UnionOfVectors, simd_union<isa::avx2>)->Apply(overlap_args);
+BENCHMARK_TEMPLATE(BM_UnionOfVectors, union_size)->Apply(overlap_args);
+
+static auto roaring_input(benchmark::State const& state, int64_t universe)
+    -> std::pair<benchunion::roaring_set, benchunion::roaring_set> {
+  auto const [xs, ys] = union_input<std::vector<int>>(state, universe);
+  auto rxs = benchunion::roaring_set{};
+  auto rys = benchunion::roaring_set{};
+  for (auto x : xs) rxs.insert(x);
+  for (auto y : ys) rys.insert(y);
+  return {std::move(rxs), std::move(rys)};
+}
+
+static void BM_UnionWithRoaring(benchmark::State& state) {
+  auto const [xs, ys] = roaring_input(state, workload::wide);
   while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = std::vector<int>{};
-    auto ys = std::vector<int>{};
+    auto z = benchunion::roaringset_union(xs, ys);
+    benchmark::DoNotOptimize(z);
+  }
+  state.SetLabel(label(state) + " bytes/elem: " + std::to_string(double(xs.bytes() + ys.bytes()) / (2 * state.range(0))));
+}
+BENCHMARK(BM_UnionWithRoaring)->Apply(union_args);
+
+// Sets of n values from [0, 2n), run-optimized.
+static void BM_UnionWithRoaringDense(benchmark::State& state) {
+  auto [xs, ys] = roaring_input(state, 2 * state.range(0));
+  xs.run_optimize();
+  ys.run_optimize();
+  while (state.KeepRunning()) {
+    auto z = benchunion::roaringset_union(xs, ys);
+    benchmark::DoNotOptimize(z);
+  }
+  state.SetLabel(label(state) + " bytes/elem: " + std::to_string(double(xs.bytes() + ys.bytes()) / (2 * state.range(0))));
+}
+BENCHMARK(BM_UnionWithRoaringDense)->Apply(union_args);
+
+// BM_UnionWithStdSetInsert and friends again, with the inputs and the result
+// allocated from an arena or a pool: the difference with the runs above is
+// the share of the allocator. As above, only the operation and the freeing
+// of its result are timed: the inputs and their memory, which cannot be
+// kept across iterations since an arena only grows, are freed without timing.
+template<typename Alloc>
+struct stdset_union_in {
+  using set = std::set<int, std::less<int>, Alloc>;
+  static auto insert(set& xs, int k) { xs.insert(k); }
+  static auto run(set const& xs, set const& ys) { return benchunion::stdset_union(xs, ys); }
+};
+
+template<typename Alloc>
+struct flatset_union_in {
+  using set = boost::container::flat_set<int, std::less<int>, Alloc>;
+  static auto insert(set& xs, int k) { xs.insert(k); }
+  static auto run(set const& xs, set const& ys) { return benchunion::flatset_union(xs, ys); }
+};
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
+template<typename Alloc>
+struct uset_union_in {
+  using set = std::unordered_set<int, std::hash<int>, std::equal_to<int>, Alloc>;
+  static auto insert(set& xs, int k) { xs.insert(k); }
+  static auto run(set const& xs, set const& ys) { return benchunion::stduset_union(xs, ys); }
+};
 
-    while ((signed)xs.size() < state.range(0)) benchunion::insert_unique(xs, unif(rng));
-    while ((signed)ys.size() < state.range(0)) benchunion::insert_unique(ys, unif(rng));
+template<typename Alloc>
+struct vector_union_in {
+  using set = std::vector<int, Alloc>;
+  static auto insert(set& xs, int k) { benchunion::insert_unique(xs, k); }
+  static auto run(set const& xs, set const& ys) { return benchunion::vectorset_union(xs, ys); }
+};
+
+template<typename Union>
+static void BM_UnionAllocator(benchmark::State& state) {
+  using set = typename Union::set;
+  using allocator = typename set::allocator_type;
+  auto const [xkeys, ykeys] = union_input<std::vector<int>>(state, workload::wide);
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    {
+      auto memory = typename allocator::resource_type{};
+      auto xs = set(allocator(memory));
+      auto ys = set(allocator(memory));
+      for (auto k : xkeys) Union::insert(xs, k);
+      for (auto k : ykeys) Union::insert(ys, k);
 
+      state.ResumeTiming();
+      {
+        auto z = Union::run(xs, ys);
+        benchmark::DoNotOptimize(z);
+      }
+      state.PauseTiming();
+    }
     state.ResumeTiming();
-    auto z = benchunion::vectorset_union(xs, ys);
   }
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_UnionWithVector)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
 
-static void BM_UnionWithVectorNoBack(benchmark::State& state) {
+using arena = benchunion::arena_allocator<int>;
+using pool = benchunion::pool_allocator<int>;
+BENCHMARK_TEMPLATE(BM_UnionAllocator, stdset_union_in<arena>)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionAllocator, stdset_union_in<pool>)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionAllocator, flatset_union_in<arena>)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionAllocator, uset_union_in<arena>)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionAllocator, uset_union_in<pool>)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionAllocator, vector_union_in<arena>)->Apply(union_args);
+
+// The union as a new container, into a buffer, only counted, and merged in
+// place into xs, for each kind of set. The inputs are those of the vector
+// unions, built once per benchmark.
+
+struct stdset_union_forms {
+  using set = std::set<int>;
+  static auto fresh(set const& xs, set const& ys) { return benchunion::stdset_union(xs, ys); }
+  template<typename Out>
+  static auto into(set const& xs, set const& ys, Out out) { return benchunion::stdset_union_into(xs, ys, out); }
+  static auto size(set const& xs, set const& ys) { return benchunion::stdset_union_size(xs, ys); }
+  static auto inplace(set& xs, set const& ys) { benchunion::stdset_union_inplace(xs, ys); }
+};
+
+struct flatset_union_forms {
+  using set = boost::container::flat_set<int>;
+  static auto fresh(set const& xs, set const& ys) { return benchunion::flatset_union(xs, ys); }
+  template<typename Out>
+  static auto into(set const& xs, set const& ys, Out out) { return benchunion::flatset_union_into(xs, ys, out); }
+  static auto size(set const& xs, set const& ys) { return benchunion::flatset_union_size(xs, ys); }
+  static auto inplace(set& xs, set const& ys) { benchunion::flatset_union_inplace(xs, ys); }
+};
+
+struct uset_union_forms {
+  using set = std::unordered_set<int>;
+  static auto fresh(set const& xs, set const& ys) { return benchunion::stduset_union(xs, ys); }
+  template<typename Out>
+  static auto into(set const& xs, set const& ys, Out out) { return benchunion::stduset_union_into(xs, ys, out); }
+  static auto size(set const& xs, set const& ys) { return benchunion::stduset_union_size(xs, ys); }
+  static auto inplace(set& xs, set const& ys) { benchunion::stduset_union_inplace(xs, ys); }
+};
+
+struct vector_union_forms {
+  using set = std::vector<int>;
+  static auto fresh(set const& xs, set const& ys) { return benchunion::vectorset_union(xs, ys); }
+  template<typename Out>
+  static auto into(set const& xs, set const& ys, Out out) { return benchunion::vectorset_union_into(xs, ys, out); }
+  static auto size(set const& xs, set const& ys) { return benchunion::vectorset_union_size(xs, ys); }
+  static auto inplace(set& xs, set const& ys) { benchunion::vectorset_union_inplace(xs, ys); }
+};
+
+struct swiss_union_forms {
+  using set = benchunion::swiss_set<int>;
+  static auto fresh(set const& xs, set const& ys) { return benchunion::swissset_union(xs, ys); }
+  template<typename Out>
+  static auto into(set const& xs, set const& ys, Out out) { return benchunion::swissset_union_into(xs, ys, out); }
+  static auto size(set const& xs, set const& ys) { return benchunion::swissset_union_size(xs, ys); }
+  static auto inplace(set& xs, set const& ys) { benchunion::swissset_union_inplace(xs, ys); }
+};
+
+struct roaring_union_forms {
+  using set = benchunion::roaring_set;
+  static auto fresh(set const& xs, set const& ys) { return benchunion::roaringset_union(xs, ys); }
+  template<typename Out>
+  static auto into(set const& xs, set const& ys, Out out) { return benchunion::roaringset_union_into(xs, ys, out); }
+  static auto size(set const& xs, set const& ys) { return benchunion::roaringset_union_size(xs, ys); }
+  static auto inplace(set& xs, set const& ys) { benchunion::roaringset_union_inplace(xs, ys); }
+};
+
+struct myflat_union_forms {
+  using set = my::flat_set<int>;
+  static auto fresh(set const& xs, set const& ys) {
+    auto v = std::vector<int>{};
+    v.reserve(xs.size() + ys.size());
+    benchunion::sorted_union_into(xs.begin(), xs.end(), ys.begin(), ys.end(), std::back_inserter(v));
+    return set(my::ordered_unique_range, std::move(v));
+  }
+  template<typename Out>
+  static auto into(set const& xs, set const& ys, Out out) { return benchunion::sorted_union_into(xs.begin(), xs.end(), ys.begin(), ys.end(), out); }
+  static auto size(set const& xs, set const& ys) { return benchunion::sorted_union_size(xs.begin(), xs.end(), ys.begin(), ys.end()); }
+  static auto inplace(set& xs, set const& ys) { xs |= ys; }
+};
+
+template<typename Forms>
+static void BM_UnionNew(benchmark::State& state) {
+  auto const [xs, ys] = union_input<typename Forms::set>(state, 4 * state.range(0));
   while (state.KeepRunning()) {
-    state.PauseTiming();
-    auto xs = std::vector<int>{};
-    auto ys = std::vector<int>{};
+    auto z = Forms::fresh(xs, ys);
+    benchmark::DoNotOptimize(z.size());
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+  state.SetLabel(label(state));
+}
 
-    auto unif = std::uniform_int_distribution<int>();
-    auto rng = std::mt19937_64(state.range(0));
+// Into a buffer allocated once.
+template<typename Forms>
+static void BM_UnionInto(benchmark::State& state) {
+  auto const [xs, ys] = union_input<typename Forms::set>(state, 4 * state.range(0));
+  auto out = std::vector<int>(2 * state.range(0));
+  while (state.KeepRunning()) {
+    auto end = Forms::into(xs, ys, out.begin());
+    benchmark::DoNotOptimize(end);
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+  state.SetLabel(label(state));
+}
 
-    while ((signed)xs.size() < state.range(0)) benchunion::insert_unique_noback(xs, unif(rng));
-    while ((signed)ys.size() < state.range(0)) benchunion::insert_unique_noback(ys, unif(rng));
+template<typename Forms>
+static void BM_UnionSize(benchmark::State& state) {
+  auto const [xs, ys] = union_input<typename Forms::set>(state, 4 * state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(Forms::size(xs, ys));
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+  state.SetLabel(label(state));
+}
 
+// Into a copy of xs, made without timing.
+template<typename Forms>
+static void BM_UnionInPlace(benchmark::State& state) {
+  auto const [xs, ys] = union_input<typename Forms::set>(state, 4 * state.range(0));
+  auto zs = typename Forms::set{};
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    zs = xs;
     state.ResumeTiming();
-    auto z = benchunion::vectorset_union_noback(xs, ys);
+    Forms::inplace(zs, ys);
   }
+  state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+  state.SetLabel(label(state));
 }
-BENCHMARK(BM_UnionWithVectorNoBack)
-    ->Args({100})
-    ->Args({1000})
-    ->Args({10000})
-    ->Args({100000});
 
+BENCHMARK_TEMPLATE(BM_UnionNew, stdset_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionNew, flatset_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionNew, uset_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionNew, vector_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionNew, myflat_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionNew, swiss_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionNew, roaring_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionInto, stdset_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionInto, flatset_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionInto, uset_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionInto, vector_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionInto, myflat_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionInto, swiss_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionInto, roaring_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionSize, stdset_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionSize, flatset_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionSize, uset_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionSize, vector_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionSize, myflat_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionSize, swiss_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionSize, roaring_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionInPlace, stdset_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionInPlace, flatset_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionInPlace, uset_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionInPlace, vector_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionInPlace, myflat_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionInPlace, swiss_union_forms)->Apply(union_args);
+BENCHMARK_TEMPLATE(BM_UnionInPlace, roaring_union_forms)->Apply(union_args);
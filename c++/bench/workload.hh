@@ -0,0 +1,231 @@
+#ifndef WORKLOAD_HH_
+#define WORKLOAD_HH_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Keys and queries for the set benchmarks, drawn before timing from a
+// seeded generator: the timed loops only read them, and two runs with the
+// same arguments see the same data. A benchmark takes the distribution as
+// an argument, 'dist(state.range(1))', and reports 'name' in its label.
+namespace workload {
+
+enum class dist : int {
+  uniform,     // every value of the universe equally likely
+  zipf,        // small values much likelier than large ones: a dense head, a sparse tail
+  clustered,   // runs of 64 consecutive values, spread over the universe
+  sequential,  // increasing, with random gaps of about universe / n: auto-increment ids
+};
+
+constexpr dist dists[] = {dist::uniform, dist::zipf, dist::clustered, dist::sequential};
+
+inline auto name(dist d) -> char const* {
+  switch (d) {
+    case dist::uniform: return "uniform";
+    case dist::zipf: return "zipf";
+    case dist::clustered: return "clustered";
+    case dist::sequential: return "sequential";
+  }
+  return "?";
+}
+
+// A universe for keys as sparse as arbitrary ints, small enough that
+// clustered and sequential keys, which may overshoot it, stay ints.
+constexpr int64_t wide = int64_t{1} << 30;
+
+// Zipf's law over [0, n): k comes with a probability about proportional to
+// 1 / (k + 1)^s. Sampled by inverting the continuous law, in constant time,
+// where std::discrete_distribution would need a table of n weights.
+class zipf_distribution {
+ public:
+  explicit zipf_distribution(int64_t n, double s = 1.0)
+      : m_n(n), m_s(s),
+        m_scale(s == 1.0? std::log(double(n) + 1) : std::pow(double(n) + 1, 1 - s) - 1) {}
+
+  template<typename Rng>
+  auto operator()(Rng& rng) -> int64_t {
+    auto const u = m_unif(rng);
+    auto const x = m_s == 1.0? std::exp(u * m_scale) : std::pow(1 + u * m_scale, 1 / (1 - m_s));
+    return std::min(int64_t(x) - 1, m_n - 1);
+  }
+
+ private:
+  int64_t m_n;
+  double m_s;
+  double m_scale;
+  std::uniform_real_distribution<double> m_unif{0.0, 1.0};
+};
+
+namespace detail {
+
+// n distinct values of 'draw', from [0, universe), sorted. Duplicates are
+// dropped with a bitmap of the universe when it is not much larger than n,
+// and else by sorting what was drawn and drawing again what is missing.
+template<typename Draw>
+auto distinct(int n, int64_t universe, Draw draw) -> std::vector<int> {
+  auto xs = std::vector<int>{};
+  xs.reserve(n);
+  if (universe <= int64_t{64} * n) {
+    auto seen = std::vector<bool>(universe);
+    while ((signed)xs.size() < n) {
+      auto const x = draw();
+      if (!seen[x]) {
+        seen[x] = true;
+        xs.push_back(int(x));
+      }
+    }
+    std::sort(xs.begin(), xs.end());
+    return xs;
+  }
+  while ((signed)xs.size() < n) {
+    auto const had = xs.size();
+    while ((signed)xs.size() < n) xs.push_back(int(draw()));
+    std::sort(xs.begin() + had, xs.end());
+    std::inplace_merge(xs.begin(), xs.begin() + had, xs.end());
+    xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+  }
+  return xs;
+}
+
+// n increasing values from 0, with the gaps drawn from 'gap'.
+template<typename Gap>
+auto ascending(int n, Gap gap) -> std::vector<int> {
+  auto xs = std::vector<int>(n);
+  auto x = int64_t{0};
+  for (auto& e : xs) {
+    e = int(x);
+    x += gap();
+  }
+  return xs;
+}
+
+} /* end namespace detail */
+
+// n distinct keys of 'd' from about [0, universe), sorted. Uniform and Zipf
+// keys are exactly within it, and need n <= universe, Zipf ones a universe
+// well over n not to wait for the rarest values; clustered and sequential
+// ones are built in linear time, and spread over it on average.
+inline auto sorted_keys(std::mt19937_64& rng, dist d, int n, int64_t universe) -> std::vector<int> {
+  assert(n <= universe && universe <= wide);
+  switch (d) {
+    case dist::uniform: {
+      auto unif = std::uniform_int_distribution<int64_t>(0, universe - 1);
+      return detail::distinct(n, universe, [&] { return unif(rng); });
+    }
+    case dist::zipf: {
+      auto zipf = zipf_distribution(universe);
+      return detail::distinct(n, universe, [&] { return zipf(rng); });
+    }
+    case dist::clustered: {
+      constexpr auto cluster = 64;
+      auto const clusters = std::max(1, n / cluster);
+      auto const spacing = std::max<int64_t>(1, (universe - n) / clusters);
+      auto jump = std::uniform_int_distribution<int64_t>(1, 2 * spacing - 1);
+      auto i = 0;
+      return detail::ascending(n, [&] { return ++i % cluster? 1 : jump(rng); });
+    }
+    case dist::sequential: {
+      auto gap = std::uniform_int_distribution<int64_t>(1, std::max<int64_t>(1, 2 * universe / n - 1));
+      return detail::ascending(n, [&] { return gap(rng); });
+    }
+  }
+  return {};
+}
+
+// Keys of 'd' in the order to insert them: shuffled, but for sequential
+// keys which come in increasing order.
+inline auto insertion_order(std::mt19937_64& rng, dist d, std::vector<int> xs) -> std::vector<int> {
+  if (d != dist::sequential) std::shuffle(xs.begin(), xs.end(), rng);
+  return xs;
+}
+
+// The keys of sorted_keys, in insertion order.
+inline auto keys(std::mt19937_64& rng, dist d, int n, int64_t universe) -> std::vector<int> {
+  return insertion_order(rng, d, sorted_keys(rng, d, n, universe));
+}
+
+// Two sorted sets of nx and ny keys of 'd', 'shared' of them in both: the
+// nx + ny - shared keys of sorted_keys, dealt at random between the two.
+inline auto overlapping_keys(std::mt19937_64& rng, dist d, int nx, int ny, int shared, int64_t universe)
+    -> std::pair<std::vector<int>, std::vector<int>> {
+  assert(shared <= nx && shared <= ny);
+  auto const all = sorted_keys(rng, d, nx + ny - shared, universe);
+  auto xs = std::vector<int>{};
+  auto ys = std::vector<int>{};
+  xs.reserve(nx);
+  ys.reserve(ny);
+  auto both = int64_t{shared}, only_x = int64_t{nx - shared}, only_y = int64_t{ny - shared};
+  for (auto k : all) {
+    auto const r = std::uniform_int_distribution<int64_t>(0, both + only_x + only_y - 1)(rng);
+    if (r < both) {
+      --both;
+      xs.push_back(k);
+      ys.push_back(k);
+    } else if (r < both + only_x) {
+      --only_x;
+      xs.push_back(k);
+    } else {
+      --only_y;
+      ys.push_back(k);
+    }
+  }
+  return {std::move(xs), std::move(ys)};
+}
+
+// Two sorted sets of n keys sharing 'percent' % of them.
+inline auto overlapping_keys(std::mt19937_64& rng, dist d, int n, int percent, int64_t universe)
+    -> std::pair<std::vector<int>, std::vector<int>> {
+  return overlapping_keys(rng, d, n, n, int(int64_t{n} * percent / 100), universe);
+}
+
+// 'count' lookups into the sorted keys 'xs', a share 'hits' of them for
+// keys of xs and the others for values next to one, not in it. Which keys
+// the lookups go to follows 'd' too: any key alike, a few hot keys
+// scattered over xs, runs of 64 neighbouring keys, or increasing keys.
+inline auto queries(std::mt19937_64& rng, dist d, std::vector<int> const& xs, size_t count, double hits = 0.5)
+    -> std::vector<int> {
+  auto const n = int64_t(xs.size());
+  auto unif = std::uniform_int_distribution<int64_t>(0, n - 1);
+  auto zipf = zipf_distribution(n);
+  auto hit = std::bernoulli_distribution(hits);
+
+  // Zipf ranks go through k -> k * stride mod n, a permutation, so that the
+  // hot keys are not all the smallest ones.
+  auto stride = int64_t{0x9e3779b1} % n;
+  while (std::gcd(stride, n) != 1) ++stride;
+
+  // A value out of xs next to its i-th key: after the end of the run of
+  // consecutive values the key is in, or past all keys.
+  auto const miss = [&](int64_t i) {
+    for (auto const end = std::min(n, i + 64); i < end; ++i)
+      if (i + 1 == n || xs[i + 1] != xs[i] + 1) return xs[i] + 1;
+    return xs.back() + 1;
+  };
+
+  auto qs = std::vector<int>(count);
+  auto start = unif(rng);
+  for (auto q = size_t{0}; q < count; ++q) {
+    auto i = int64_t{0};
+    switch (d) {
+      case dist::uniform: i = unif(rng); break;
+      case dist::zipf: i = int64_t(__uint128_t(zipf(rng)) * stride % n); break;
+      case dist::clustered:
+        if (q % 64 == 0) start = unif(rng);
+        i = (start + int64_t(q % 64)) % n;
+        break;
+      case dist::sequential: i = (start + int64_t(q)) % n; break;
+    }
+    qs[q] = hit(rng)? xs[i] : miss(i);
+  }
+  return qs;
+}
+
+} /* end namespace workload */
+
+#endif
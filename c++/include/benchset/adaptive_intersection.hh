@@ -0,0 +1,139 @@
+#ifndef BENCH_ADAPTIVE_INTERSECTION_HH_
+#define BENCH_ADAPTIVE_INTERSECTION_HH_
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include <boost/container/flat_set.hpp>
+#include "benchset/simd_intersection.hh"
+
+// Intersections whose cost depends on the smaller input when the sizes are
+// skewed: a linear merge is O(m + n), galloping and Baeza-Yates are
+// O(m log(n/m)) for m <= n.
+namespace benchunion {
+
+// Lower bound in [first, last) for a value expected near 'first': probes at
+// distances 1, 2, 4, ... then binary searches the last interval.
+template<typename It, typename T>
+auto gallop_lower_bound(It first, It last, T const& value) -> It {
+  auto const n = std::distance(first, last);
+  auto step = decltype(n){1};
+  auto lo = decltype(n){0};
+  while (step <= n && *std::next(first, step - 1) < value) {
+    lo = step;
+    step *= 2;
+  }
+  return std::lower_bound(std::next(first, lo), std::next(first, std::min(step, n)), value);
+}
+
+// Each element of the smaller input is searched for in the larger one,
+// galloping from where the previous search stopped.
+template<typename It1, typename It2, typename Out>
+auto galloping_intersection(It1 xs_first, It1 xs_last, It2 ys_first, It2 ys_last, Out out) -> Out {
+  if (std::distance(xs_first, xs_last) > std::distance(ys_first, ys_last))
+    return galloping_intersection(ys_first, ys_last, xs_first, xs_last, out);
+
+  for (; xs_first != xs_last && ys_first != ys_last; ++xs_first) {
+    ys_first = gallop_lower_bound(ys_first, ys_last, *xs_first);
+    if (ys_first != ys_last && !(*xs_first < *ys_first)) {
+      *out++ = *xs_first;
+      ++ys_first;
+    }
+  }
+  return out;
+}
+
+// Baeza-Yates: the median of the smaller input splits the larger one by
+// binary search, and both halves are intersected recursively. The recursion
+// is only O(log m) deep.
+template<typename It1, typename It2, typename Out>
+auto baeza_yates_intersection(It1 xs_first, It1 xs_last, It2 ys_first, It2 ys_last, Out out) -> Out {
+  auto const m = std::distance(xs_first, xs_last);
+  auto const n = std::distance(ys_first, ys_last);
+  if (m == 0 || n == 0)
+    return out;
+  if (m > n)
+    return baeza_yates_intersection(ys_first, ys_last, xs_first, xs_last, out);
+
+  auto const mid = std::next(xs_first, m / 2);
+  auto const pos = std::lower_bound(ys_first, ys_last, *mid);
+  out = baeza_yates_intersection(xs_first, mid, ys_first, pos, out);
+  auto next = pos;
+  if (pos != ys_last && !(*mid < *pos)) {
+    *out++ = *mid;
+    ++next;
+  }
+  return baeza_yates_intersection(std::next(mid), xs_last, next, ys_last, out);
+}
+
+// Above these size ratios, galloping beats the linear merge and the SIMD
+// kernels respectively.
+constexpr size_t galloping_ratio = 32;
+constexpr size_t simd_galloping_ratio = 128;
+
+// Merges inputs of similar sizes and gallops through skewed ones.
+template<typename It1, typename It2, typename Out>
+auto adaptive_intersection(It1 xs_first, It1 xs_last, It2 ys_first, It2 ys_last, Out out) -> Out {
+  auto const m = size_t(std::distance(xs_first, xs_last));
+  auto const n = size_t(std::distance(ys_first, ys_last));
+  if (std::min(m, n) * galloping_ratio < std::max(m, n))
+    return galloping_intersection(xs_first, xs_last, ys_first, ys_last, out);
+  return std::set_intersection(xs_first, xs_last, ys_first, ys_last, out);
+}
+
+template<typename T, typename A>
+auto vectorset_intersection_galloping(std::vector<T, A> const& xs,
+                                      std::vector<T, A> const& ys) -> std::vector<T, A> {
+  auto inter = std::vector<T, A>(xs.get_allocator());
+  inter.reserve(std::min(xs.size(), ys.size()));
+  galloping_intersection(xs.begin(), xs.end(), ys.begin(), ys.end(), std::back_inserter(inter));
+  return inter;
+}
+
+template<typename T, typename A>
+auto vectorset_intersection_baeza_yates(std::vector<T, A> const& xs,
+                                        std::vector<T, A> const& ys) -> std::vector<T, A> {
+  auto inter = std::vector<T, A>(xs.get_allocator());
+  inter.reserve(std::min(xs.size(), ys.size()));
+  baeza_yates_intersection(xs.begin(), xs.end(), ys.begin(), ys.end(), std::back_inserter(inter));
+  return inter;
+}
+
+// Like adaptive_intersection, but inputs of similar sizes of 32-bit integers
+// go through the SIMD kernels.
+template<typename T, typename A>
+auto vectorset_intersection_adaptive(std::vector<T, A> const& xs,
+                                     std::vector<T, A> const& ys) -> std::vector<T, A> {
+  auto const m = std::min(xs.size(), ys.size()), n = std::max(xs.size(), ys.size());
+  if constexpr (simd::detail::is_word<T>) {
+    if (m * simd_galloping_ratio >= n)
+      return vectorset_intersection_simd(xs, ys);
+  }
+  auto inter = std::vector<T, A>(xs.get_allocator());
+  inter.reserve(m);
+  adaptive_intersection(xs.begin(), xs.end(), ys.begin(), ys.end(), std::back_inserter(inter));
+  return inter;
+}
+
+template<typename T, typename A>
+auto flatset_intersection_adaptive(boost::container::flat_set<T, std::less<T>, A> const& xs,
+                                   boost::container::flat_set<T, std::less<T>, A> const& ys)
+                                   -> boost::container::flat_set<T, std::less<T>, A> {
+  auto const m = std::min(xs.size(), ys.size()), n = std::max(xs.size(), ys.size());
+  if constexpr (simd::detail::is_word<T>) {
+    if (m * simd_galloping_ratio >= n)
+      return flatset_intersection_simd(xs, ys);
+  }
+  auto seq = typename boost::container::flat_set<T, std::less<T>, A>::sequence_type(
+    xs.get_allocator());
+  seq.reserve(m);
+  adaptive_intersection(xs.begin(), xs.end(), ys.begin(), ys.end(), std::back_inserter(seq));
+  auto inter = boost::container::flat_set<T, std::less<T>, A>(xs.get_allocator());
+  inter.adopt_sequence(boost::container::ordered_unique_range, std::move(seq));
+  return inter;
+}
+
+} /* end namespace benchunion */
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef BENCH_ARENA_HH_
+#define BENCH_ARENA_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Memory resources for the containers of the set operations, and allocators
+// that draw from them:
+//
+//  - monotonic_arena: bumps a pointer through large chunks and frees them all
+//    at once when the arena goes away; deallocation does nothing;
+//  - node_pool: keeps a free list per block size, so the one-element
+//    allocations of node containers like std::set are a pop and a push.
+//
+// Both are for one thread, and must outlive the containers using them.
+namespace benchunion {
+
+class monotonic_arena {
+ public:
+  explicit monotonic_arena(size_t chunk_bytes = size_t{1} << 16) : m_chunk_bytes(chunk_bytes) {}
+  monotonic_arena(monotonic_arena const&) = delete;
+  auto operator=(monotonic_arena const&) -> monotonic_arena& = delete;
+  ~monotonic_arena() { release(); }
+
+  auto allocate(size_t bytes, size_t align) -> void* {
+    auto p = (m_next + (align - 1)) & ~uintptr_t(align - 1);
+    if (p + bytes > m_end) {
+      grow(bytes + align);
+      p = (m_next + (align - 1)) & ~uintptr_t(align - 1);
+    }
+    m_next = p + bytes;
+    m_used += bytes;
+    return reinterpret_cast<void*>(p);
+  }
+
+  // Frees every chunk: whatever was allocated from the arena is gone.
+  auto release() noexcept -> void {
+    while (m_chunks) {
+      auto* const next = m_chunks->next;
+      ::operator delete(m_chunks);
+      m_chunks = next;
+    }
+    m_next = m_end = 0;
+    m_used = 0;
+  }
+
+  // Bytes handed out since the last release.
+  auto used() const noexcept -> size_t { return m_used; }
+
+ private:
+  struct chunk { chunk* next; };
+
+  // Chunks double in size, up to the first one times 1024, so a container
+  // growing geometrically does not make a chunk per reallocation.
+  auto grow(size_t bytes) -> void {
+    auto const size = std::max(bytes, m_chunk_bytes) + sizeof(chunk);
+    auto* const c = static_cast<chunk*>(::operator new(size));
+    c->next = m_chunks;
+    m_chunks = c;
+    m_next = reinterpret_cast<uintptr_t>(c + 1);
+    m_end = reinterpret_cast<uintptr_t>(c) + size;
+    m_chunk_bytes = std::min(m_chunk_bytes * 2, m_max_chunk_bytes);
+  }
+
+  chunk* m_chunks = nullptr;
+  uintptr_t m_next = 0;
+  uintptr_t m_end = 0;
+  size_t m_used = 0;
+  size_t m_chunk_bytes;
+  size_t const m_max_chunk_bytes = m_chunk_bytes * 1024;
+};
+
+class node_pool {
+ public:
+  // Blocks are multiples of 'granule' bytes up to 'max_block'; bigger
+  // allocations go to operator new.
+  static constexpr size_t granule = alignof(std::max_align_t);
+  static constexpr size_t max_block = 256;
+
+  explicit node_pool(size_t blocks_per_chunk = 1024) : m_blocks_per_chunk(blocks_per_chunk) {}
+  node_pool(node_pool const&) = delete;
+  auto operator=(node_pool const&) -> node_pool& = delete;
+  ~node_pool() {
+    while (m_chunks) {
+      auto* const next = m_chunks->next;
+      ::operator delete(m_chunks);
+      m_chunks = next;
+    }
+  }
+
+  auto allocate(size_t bytes) -> void* {
+    if (bytes > max_block) return ::operator new(bytes);
+    auto& head = m_free[size_class(bytes)];
+    if (!head) refill(size_class(bytes));
+    auto* const b = head;
+    head = b->next;
+    return b;
+  }
+
+  auto deallocate(void* p, size_t bytes) noexcept -> void {
+    if (bytes > max_block) return ::operator delete(p);
+    auto* const b = static_cast<block*>(p);
+    auto& head = m_free[size_class(bytes)];
+    b->next = head;
+    head = b;
+  }
+
+ private:
+  struct block { block* next; };
+  struct alignas(std::max_align_t) chunk { chunk* next; };
+
+  static constexpr auto size_class(size_t bytes) -> size_t {
+    return (std::max<size_t>(bytes, 1) - 1) / granule;
+  }
+
+  // Carves a new chunk into blocks of class c, threaded in address order.
+  auto refill(size_t c) -> void {
+    auto const size = (c + 1) * granule;
+    auto* const ch = static_cast<chunk*>(::operator new(sizeof(chunk) + size * m_blocks_per_chunk));
+    ch->next = m_chunks;
+    m_chunks = ch;
+    auto* const first = reinterpret_cast<char*>(ch + 1);
+    for (auto i = m_blocks_per_chunk; i-- > 0;) {
+      auto* const b = reinterpret_cast<block*>(first + i * size);
+      b->next = m_free[c];
+      m_free[c] = b;
+    }
+  }
+
+  size_t m_blocks_per_chunk;
+  block* m_free[max_block / granule] = {};
+  chunk* m_chunks = nullptr;
+};
+
+// The allocators only hold a pointer to their resource: copies, and copies
+// rebound to other types, share it and compare equal.
+template<typename T>
+struct arena_allocator {
+  using value_type = T;
+  using resource_type = monotonic_arena;
+
+  explicit arena_allocator(monotonic_arena& arena) noexcept : arena(&arena) {}
+  template<typename U>
+  arena_allocator(arena_allocator<U> const& other) noexcept : arena(other.arena) {}
+
+  auto allocate(size_t n) -> T* { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+  auto deallocate(T*, size_t) noexcept -> void {}
+
+  template<typename U>
+  friend auto operator==(arena_allocator const& a, arena_allocator<U> const& b) -> bool {
+    return a.arena == b.arena;
+  }
+  template<typename U>
+  friend auto operator!=(arena_allocator const& a, arena_allocator<U> const& b) -> bool {
+    return a.arena != b.arena;
+  }
+
+  monotonic_arena* arena;
+};
+
+template<typename T>
+struct pool_allocator {
+  using value_type = T;
+  using resource_type = node_pool;
+
+  static_assert(alignof(T) <= node_pool::granule, "over-aligned types are not pooled");
+
+  explicit pool_allocator(node_pool& pool) noexcept : pool(&pool) {}
+  template<typename U>
+  pool_allocator(pool_allocator<U> const& other) noexcept : pool(other.pool) {}
+
+  auto allocate(size_t n) -> T* { return static_cast<T*>(pool->allocate(n * sizeof(T))); }
+  auto deallocate(T* p, size_t n) noexcept -> void { pool->deallocate(p, n * sizeof(T)); }
+
+  template<typename U>
+  friend auto operator==(pool_allocator const& a, pool_allocator<U> const& b) -> bool {
+    return a.pool == b.pool;
+  }
+  template<typename U>
+  friend auto operator!=(pool_allocator const& a, pool_allocator<U> const& b) -> bool {
+    return a.pool != b.pool;
+  }
+
+  node_pool* pool;
+};
+
+} /* end namespace benchunion */
+
+#endif
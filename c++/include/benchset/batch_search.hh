@@ -0,0 +1,59 @@
+#ifndef BENCH_BATCH_SEARCH_HH_
+#define BENCH_BATCH_SEARCH_HH_
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+// Many binary searches over the same sorted array, interleaved to hide the
+// memory latency (group prefetching, Chen et al.). A lone binary search
+// waits for each probe before it knows the next one; a group of searches
+// moves one step at a time, all together, and each step prefetches the next
+// probe of every search before any of them is loaded.
+namespace benchunion {
+
+// Searches per group: enough loads in flight to cover a miss to memory.
+constexpr size_t search_group = 16;
+
+// Calls f(key, i) for each key of [first, last), in order, where i is the
+// index in xs[0, n) of the first element e with !less(e, key), or n. The
+// searches are branchless: the length of the range left only depends on n,
+// so every search of a group takes the same steps.
+template<typename T, typename KeyIt, typename Less, typename F>
+auto lower_bound_batch(T const* xs, size_t n, KeyIt first, KeyIt last, Less less, F&& f) -> void {
+  KeyIt keys[search_group];
+  T const* base[search_group];
+  while (first != last) {
+    auto g = size_t{0};
+    for (; g < search_group && first != last; ++g, ++first) {
+      keys[g] = first;
+      base[g] = xs;
+    }
+    for (auto len = n; len > 1;) {
+      auto const half = len / 2;
+      for (auto j = size_t{0}; j < g; ++j)
+        base[j] += less(base[j][half - 1], *keys[j])? half : 0;
+      len -= half;
+      if (len > 1)
+        for (auto j = size_t{0}; j < g; ++j) __builtin_prefetch(base[j] + len / 2 - 1);
+    }
+    for (auto j = size_t{0}; j < g; ++j)
+      f(*keys[j], n == 0? 0 : size_t(base[j] - xs) + less(*base[j], *keys[j]));
+  }
+}
+
+// Writes, for each key of [first, last), the iterator to it in the sorted
+// vector xs, or xs.end().
+template<typename T, typename A, typename KeyIt, typename OutIt>
+auto vectorset_find_batch(std::vector<T, A> const& xs, KeyIt first, KeyIt last, OutIt out) -> OutIt {
+  lower_bound_batch(xs.data(), xs.size(), first, last, std::less<>{},
+    [&](auto const& k, size_t i) {
+      *out++ = i < xs.size() && !(k < xs[i])? xs.begin() + i : xs.end();
+    });
+  return out;
+}
+
+} /* end namespace benchunion */
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef BUFFERED_FLAT_HH_
+#define BUFFERED_FLAT_HH_
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include "benchset/myflat.hh"
+
+namespace my {
+
+/**
+ * A set kept as a few sorted runs, for workloads that mix inserts and finds
+ * (the logarithmic method of Bentley and Saxe). New keys go into a small
+ * sorted buffer. A full buffer is carried down the levels like a bit of a
+ * binary counter: it is merged with the run of level 0, then with the run of
+ * level 1, and so on until an empty level takes the result. Each key is
+ * merged O(log n) times, and a find makes one binary search per level.
+ */
+template<typename Key>
+class buffered_flat_set {
+ public:
+  using key_type = Key;
+  using value_type = key_type;
+  using size_type = size_t;
+
+  /** Keys in the buffer before it is merged into the runs. */
+  static constexpr size_type buffer_size = 64;
+
+  buffered_flat_set() = default;
+
+  template<typename It>
+  buffered_flat_set(It first, It last) {
+    auto run = vector<key_type>(first, last);
+    std::sort(run.begin(), run.end());
+    run.erase(std::unique(run.begin(), run.end()), run.end());
+    m_size = run.size();
+    if (!run.empty()) m_levels.push_back(std::move(run));
+  }
+
+  /** Returns whether the container is empty. */
+  auto empty() const noexcept -> bool { return m_size == 0; }
+
+  /** Returns how many elements are in the container. */
+  auto size() const noexcept -> size_type { return m_size; }
+
+  auto contains(key_type const& k) const -> bool {
+    if (std::binary_search(m_buffer.begin(), m_buffer.end(), k)) return true;
+    // The deeper levels hold more keys: search them first.
+    for (auto run = m_levels.rbegin(); run != m_levels.rend(); ++run)
+      if (std::binary_search(run->begin(), run->end(), k)) return true;
+    return false;
+  }
+
+  auto count(key_type const& k) const -> size_type { return contains(k)? 1 : 0; }
+
+  /** Inserts k, unless present, and returns whether it was inserted. */
+  auto insert(key_type const& k) -> bool {
+    if (contains(k)) return false;
+    m_buffer.insert(std::upper_bound(m_buffer.begin(), m_buffer.end(), k), k);
+    ++m_size;
+    if (m_buffer.size() == buffer_size) carry();
+    return true;
+  }
+
+  /** Merges everything into one run, which is then the fastest to search. */
+  auto compact() -> void {
+    auto run = std::move(m_buffer);
+    m_buffer.clear();
+    for (auto& level : m_levels) {
+      run = merge(level, run);
+      level = vector<key_type>{};
+    }
+    m_levels.clear();
+    if (!run.empty()) m_levels.push_back(std::move(run));
+  }
+
+  /** Compacts the set and returns its keys, in order. */
+  auto sorted() -> vector<key_type> const& {
+    compact();
+    static auto const none = vector<key_type>{};
+    return m_levels.empty()? none : m_levels.front();
+  }
+
+ private:
+  static auto merge(vector<key_type> const& xs, vector<key_type> const& ys) -> vector<key_type> {
+    auto m = vector<key_type>{};
+    m.reserve(xs.size() + ys.size());
+    std::merge(xs.begin(), xs.end(), ys.begin(), ys.end(), std::back_inserter(m));
+    return m;
+  }
+
+  auto carry() -> void {
+    auto run = std::move(m_buffer);
+    m_buffer = vector<key_type>{};
+    m_buffer.reserve(buffer_size);
+    auto i = size_t{0};
+    for (; i < m_levels.size() && !m_levels[i].empty(); ++i) {
+      run = merge(m_levels[i], run);
+      m_levels[i] = vector<key_type>{};
+    }
+    if (i == m_levels.size()) m_levels.emplace_back();
+    m_levels[i] = std::move(run);
+  }
+
+  vector<key_type> m_buffer;
+  vector<vector<key_type>> m_levels;
+  size_type m_size = 0;
+};
+
+} /* end namespace my */
+
+#endif
@@ -7,8 +7,8 @@
 
 namespace benchunion {
 
-template<typename T>
-auto insert_unique(std::vector<T>& v, T const& t) -> bool {
+template<typename T, typename A>
+auto insert_unique(std::vector<T, A>& v, T const& t) -> bool {
   if (v.empty() || v.back() < t) {
     v.push_back(t);
     return true;
@@ -22,15 +22,15 @@ auto insert_unique(std::vector<T>& v, T const& t) -> bool {
   return false;
 }
 
-template<typename T>
-auto insert_unique_noback(std::vector<T>& v, T const& t) -> bool {
+template<typename T, typename A>
+auto insert_unique_noback(std::vector<T, A>& v, T const& t) -> bool {
   if (v.empty()) {
     v.push_back(t);
     return true;
   }
 
   auto const it = std::lower_bound(v.begin(), v.end(), t);
-  if (*it != t) {
+  if (it == v.end() || *it != t) {
     v.insert(it, t);
     return true;
   }
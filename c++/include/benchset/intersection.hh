@@ -2,6 +2,7 @@
 #define BENCH_INTERSECTION_HH_
 
 #include <algorithm>
+#include <iterator>
 #include <vector>
 #include <set>
 #include <unordered_set>
@@ -10,11 +11,11 @@
 
 namespace benchunion {
 
-template<typename T>
-auto flatset_intersection(boost::container::flat_set<T> const& xs,
-                          boost::container::flat_set<T> const& ys)
-                          -> boost::container::flat_set<T> {
-  auto inter = boost::container::flat_set<T>{};
+template<typename T, typename A>
+auto flatset_intersection(boost::container::flat_set<T, std::less<T>, A> const& xs,
+                          boost::container::flat_set<T, std::less<T>, A> const& ys)
+                          -> boost::container::flat_set<T, std::less<T>, A> {
+  auto inter = boost::container::flat_set<T, std::less<T>, A>(xs.get_allocator());
   auto const xs_end = xs.end(), ys_end = ys.end();
   auto xs_it = xs.begin(), ys_it = ys.begin();
 
@@ -31,11 +32,11 @@ auto flatset_intersection(boost::container::flat_set<T> const& xs,
   return inter;
 }
 
-template<typename T>
-auto flatset_intersection_eh(boost::container::flat_set<T> const& xs,
-                             boost::container::flat_set<T> const& ys)
-                             -> boost::container::flat_set<T> {
-  auto inter = boost::container::flat_set<T>{};
+template<typename T, typename A>
+auto flatset_intersection_eh(boost::container::flat_set<T, std::less<T>, A> const& xs,
+                             boost::container::flat_set<T, std::less<T>, A> const& ys)
+                             -> boost::container::flat_set<T, std::less<T>, A> {
+  auto inter = boost::container::flat_set<T, std::less<T>, A>(xs.get_allocator());
   auto const xs_end = xs.end(), ys_end = ys.end();
   auto xs_it = xs.begin(), ys_it = ys.begin();
 
@@ -52,9 +53,10 @@ auto flatset_intersection_eh(boost::container::flat_set<T> const& xs,
   return inter;
 }
 
-template<typename T>
-auto stdset_intersection(std::set<T> const& xs, std::set<T> const& ys) -> std::set<T> {
-  auto inter = std::set<T>{};
+template<typename T, typename A>
+auto stdset_intersection(std::set<T, std::less<T>, A> const& xs,
+                         std::set<T, std::less<T>, A> const& ys) -> std::set<T, std::less<T>, A> {
+  auto inter = std::set<T, std::less<T>, A>(xs.get_allocator());
   auto const xs_end = xs.end(), ys_end = ys.end();
   auto xs_it = xs.begin(), ys_it = ys.begin();
 
@@ -71,9 +73,10 @@ auto stdset_intersection(std::set<T> const& xs, std::set<T> const& ys) -> std::s
   return inter;
 }
 
-template<typename T>
-auto stdset_intersection_eh(std::set<T> const& xs, std::set<T> const& ys) -> std::set<T> {
-  auto inter = std::set<T>{};
+template<typename T, typename A>
+auto stdset_intersection_eh(std::set<T, std::less<T>, A> const& xs,
+                            std::set<T, std::less<T>, A> const& ys) -> std::set<T, std::less<T>, A> {
+  auto inter = std::set<T, std::less<T>, A>(xs.get_allocator());
   auto const xs_end = xs.end(), ys_end = ys.end();
   auto xs_it = xs.begin(), ys_it = ys.begin();
 
@@ -90,21 +93,23 @@ auto stdset_intersection_eh(std::set<T> const& xs, std::set<T> const& ys) -> std
   return inter;
 }
 
-template<typename T>
-auto stduset_intersection(std::unordered_set<T> const& xs,
-                          std::unordered_set<T> const& ys) -> std::unordered_set<T> {
+template<typename T, typename H, typename E, typename A>
+auto stduset_intersection(std::unordered_set<T, H, E, A> const& xs,
+                          std::unordered_set<T, H, E, A> const& ys)
+                          -> std::unordered_set<T, H, E, A> {
   if (xs.size() > ys.size())
     return stduset_intersection(ys, xs);
 
-  auto inter = std::unordered_set<T>{};
+  auto inter = std::unordered_set<T, H, E, A>(0, xs.hash_function(), xs.key_eq(),
+                                              xs.get_allocator());
   for (auto const& x : xs) if (ys.find(x) != ys.end()) inter.insert(x);
   return inter;
 }
 
-template<typename T>
-auto vectorset_intersection(std::vector<T> const& xs,
-                            std::vector<T> const& ys) -> std::vector<T> {
-  auto inter = std::vector<T>{};
+template<typename T, typename A>
+auto vectorset_intersection(std::vector<T, A> const& xs,
+                            std::vector<T, A> const& ys) -> std::vector<T, A> {
+  auto inter = std::vector<T, A>(xs.get_allocator());
   auto const xs_end = xs.end(), ys_end = ys.end();
   auto xs_it = xs.begin(), ys_it = ys.begin();
 
@@ -121,10 +126,10 @@ auto vectorset_intersection(std::vector<T> const& xs,
   return inter;
 }
 
-template<typename T>
-auto vectorset_intersection_noback(std::vector<T> const& xs,
-                                   std::vector<T> const& ys) -> std::vector<T> {
-  auto inter = std::vector<T>{};
+template<typename T, typename A>
+auto vectorset_intersection_noback(std::vector<T, A> const& xs,
+                                   std::vector<T, A> const& ys) -> std::vector<T, A> {
+  auto inter = std::vector<T, A>(xs.get_allocator());
   auto const xs_end = xs.end(), ys_end = ys.end();
   auto xs_it = xs.begin(), ys_it = ys.begin();
 
@@ -141,6 +146,154 @@ auto vectorset_intersection_noback(std::vector<T> const& xs,
   return inter;
 }
 
+// The forms below skip the result container: the '_into' ones write the
+// intersection, in order for the sorted containers, to an output iterator,
+// the '_size' ones only count it and the '_inplace' ones keep in xs only the
+// elements also in ys.
+
+template<typename It1, typename It2, typename Out>
+auto sorted_intersection_into(It1 xs_it, It1 xs_end, It2 ys_it, It2 ys_end, Out out) -> Out {
+  while (xs_it != xs_end && ys_it != ys_end) {
+    if (*xs_it < *ys_it) {
+      ++xs_it;
+    } else {
+      if (!(*ys_it < *xs_it)) {
+        *out++ = *xs_it++;
+      }
+      ++ys_it;
+    }
+  }
+  return out;
+}
+
+template<typename It1, typename It2>
+auto sorted_intersection_size(It1 xs_it, It1 xs_end, It2 ys_it, It2 ys_end) -> size_t {
+  auto n = size_t{0};
+  while (xs_it != xs_end && ys_it != ys_end) {
+    if (*xs_it < *ys_it) {
+      ++xs_it;
+    } else {
+      if (!(*ys_it < *xs_it)) {
+        ++n;
+        ++xs_it;
+      }
+      ++ys_it;
+    }
+  }
+  return n;
+}
+
+// Keeps in the sorted sequence xs the elements found in the sorted range
+// [ys_it, ys_end), compacting them to the front in one pass.
+template<typename Seq, typename It>
+auto sorted_intersection_inplace(Seq& xs, It ys_it, It ys_end) -> void {
+  auto out = xs.begin();
+  for (auto xs_it = xs.begin(); xs_it != xs.end() && ys_it != ys_end;) {
+    if (*xs_it < *ys_it) {
+      ++xs_it;
+    } else {
+      if (!(*ys_it < *xs_it)) {
+        if (out != xs_it) *out = std::move(*xs_it);
+        ++out;
+        ++xs_it;
+      }
+      ++ys_it;
+    }
+  }
+  xs.erase(out, xs.end());
+}
+
+template<typename T, typename A, typename Out>
+auto stdset_intersection_into(std::set<T, std::less<T>, A> const& xs,
+                              std::set<T, std::less<T>, A> const& ys, Out out) -> Out {
+  return sorted_intersection_into(xs.begin(), xs.end(), ys.begin(), ys.end(), out);
+}
+
+template<typename T, typename A>
+auto stdset_intersection_size(std::set<T, std::less<T>, A> const& xs,
+                              std::set<T, std::less<T>, A> const& ys) -> size_t {
+  return sorted_intersection_size(xs.begin(), xs.end(), ys.begin(), ys.end());
+}
+
+template<typename T, typename A>
+auto stdset_intersection_inplace(std::set<T, std::less<T>, A>& xs,
+                                 std::set<T, std::less<T>, A> const& ys) -> void {
+  auto xs_it = xs.begin();
+  auto ys_it = ys.begin();
+  while (xs_it != xs.end()) {
+    while (ys_it != ys.end() && *ys_it < *xs_it) ++ys_it;
+    if (ys_it != ys.end() && !(*xs_it < *ys_it)) ++xs_it;
+    else xs_it = xs.erase(xs_it);
+  }
+}
+
+template<typename T, typename A, typename Out>
+auto flatset_intersection_into(boost::container::flat_set<T, std::less<T>, A> const& xs,
+                               boost::container::flat_set<T, std::less<T>, A> const& ys,
+                               Out out) -> Out {
+  return sorted_intersection_into(xs.begin(), xs.end(), ys.begin(), ys.end(), out);
+}
+
+template<typename T, typename A>
+auto flatset_intersection_size(boost::container::flat_set<T, std::less<T>, A> const& xs,
+                               boost::container::flat_set<T, std::less<T>, A> const& ys) -> size_t {
+  return sorted_intersection_size(xs.begin(), xs.end(), ys.begin(), ys.end());
+}
+
+template<typename T, typename A>
+auto flatset_intersection_inplace(boost::container::flat_set<T, std::less<T>, A>& xs,
+                                  boost::container::flat_set<T, std::less<T>, A> const& ys) -> void {
+  auto seq = xs.extract_sequence();
+  sorted_intersection_inplace(seq, ys.begin(), ys.end());
+  xs.adopt_sequence(boost::container::ordered_unique_range, std::move(seq));
+}
+
+template<typename T, typename H, typename E, typename A, typename Out>
+auto stduset_intersection_into(std::unordered_set<T, H, E, A> const& xs,
+                               std::unordered_set<T, H, E, A> const& ys, Out out) -> Out {
+  if (xs.size() > ys.size())
+    return stduset_intersection_into(ys, xs, out);
+
+  for (auto const& x : xs) if (ys.find(x) != ys.end()) *out++ = x;
+  return out;
+}
+
+template<typename T, typename H, typename E, typename A>
+auto stduset_intersection_size(std::unordered_set<T, H, E, A> const& xs,
+                               std::unordered_set<T, H, E, A> const& ys) -> size_t {
+  if (xs.size() > ys.size())
+    return stduset_intersection_size(ys, xs);
+
+  auto n = size_t{0};
+  for (auto const& x : xs) n += ys.find(x) != ys.end();
+  return n;
+}
+
+template<typename T, typename H, typename E, typename A>
+auto stduset_intersection_inplace(std::unordered_set<T, H, E, A>& xs,
+                                  std::unordered_set<T, H, E, A> const& ys) -> void {
+  for (auto it = xs.begin(); it != xs.end();) {
+    if (ys.find(*it) == ys.end()) it = xs.erase(it);
+    else ++it;
+  }
+}
+
+template<typename T, typename A, typename Out>
+auto vectorset_intersection_into(std::vector<T, A> const& xs, std::vector<T, A> const& ys,
+                                 Out out) -> Out {
+  return sorted_intersection_into(xs.begin(), xs.end(), ys.begin(), ys.end(), out);
+}
+
+template<typename T, typename A>
+auto vectorset_intersection_size(std::vector<T, A> const& xs, std::vector<T, A> const& ys) -> size_t {
+  return sorted_intersection_size(xs.begin(), xs.end(), ys.begin(), ys.end());
+}
+
+template<typename T, typename A>
+auto vectorset_intersection_inplace(std::vector<T, A>& xs, std::vector<T, A> const& ys) -> void {
+  sorted_intersection_inplace(xs, ys.begin(), ys.end());
+}
+
 } /* end namespace manti */
 
 #endif
@@ -0,0 +1,157 @@
+#ifndef BENCH_LEARNED_SET_HH_
+#define BENCH_LEARNED_SET_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "benchset/static_search.hh"
+
+// A read-only set of sorted keys with a learned index, after the PGM-index
+// (Ferragina and Vinciguerra, VLDB 2020): the map from a key to its rank is
+// cut into linear segments, each predicting the rank of its keys within
+// 'Epsilon'. A lookup predicts a position and binary searches the 2 Epsilon
+// keys around it, a few cache lines, instead of the whole array.
+//
+// The segments are found in one pass, by shrinking the cone of the slopes
+// that keep every key of the segment within the bound. Their first keys
+// are indexed the same way, with a bound of 'recursive_epsilon', level
+// above level until one segment is left: a lookup goes down the levels,
+// each search bounded.
+namespace benchunion {
+
+template<typename T, size_t Epsilon = 32>
+class learned_set {
+  // Predictions are computed in double, exactly for these keys.
+  static_assert(std::is_integral_v<T> && sizeof(T) <= 4, "learned_set needs integer keys of up to 32 bits");
+
+ public:
+  using value_type = T;
+
+  static constexpr size_t epsilon = Epsilon;
+  static constexpr size_t recursive_epsilon = 4;
+
+  learned_set() = default;
+
+  explicit learned_set(std::vector<T> const& sorted) : m_keys(sorted.begin(), sorted.end()) {
+    if (sorted.empty()) return;
+    auto first = size_t{0};
+    auto count = build(m_keys.data(), m_keys.size(), epsilon);
+    while (count > 1) {
+      m_levels.push_back(first);
+      auto const keys = level_keys(first, count);
+      first = m_segments.size();
+      count = build(keys.data(), keys.size(), recursive_epsilon);
+    }
+    m_levels.push_back(first);
+  }
+
+  auto size() const noexcept -> size_t { return m_keys.size(); }
+  auto empty() const noexcept -> bool { return m_keys.empty(); }
+
+  // Segments of the bottom level: the fewer, the more linear the keys.
+  auto segments() const noexcept -> size_t {
+    return m_levels.empty()? 0 : (m_levels.size() > 1? m_levels[1] : m_segments.size()) - 1;
+  }
+
+  // Bytes held by the set, including the object itself.
+  auto bytes() const noexcept -> size_t {
+    return sizeof(*this) + m_keys.capacity() * sizeof(T) + m_segments.capacity() * sizeof(segment)
+      + m_levels.capacity() * sizeof(size_t);
+  }
+
+  // The first key not less than x, or nullptr.
+  auto lower_bound(T const& x) const -> T const* {
+    auto const r = rank(x);
+    return r < m_keys.size()? &m_keys[r] : nullptr;
+  }
+
+  auto contains(T const& x) const -> bool {
+    auto const* k = lower_bound(x);
+    return k && !(x < *k);
+  }
+
+ private:
+  // Predicts 'intercept + slope (x - key)' for the keys from 'key' on. Each
+  // level ends with a sentinel whose intercept is its number of segments.
+  struct segment {
+    T key;
+    size_t intercept;
+    double slope;
+  };
+
+  // The number of keys less than x.
+  auto rank(T const& x) const -> size_t {
+    if (m_keys.empty() || !(m_keys.front() < x)) return 0;
+    auto s = m_levels.back();
+    for (auto level = m_levels.size() - 1; level-- > 0;) {
+      auto const first = m_levels[level];
+      auto const [lo, hi] = window(s, x, recursive_epsilon, m_levels[level + 1] - first - 1);
+      // The last segment of the level whose key is not greater than x.
+      auto const* const segments = m_segments.data() + first;
+      auto const it = std::upper_bound(segments + lo, segments + hi, x,
+                                       [](T const& v, segment const& seg) { return v < seg.key; });
+      s = first + size_t(it - segments) - 1;
+    }
+    auto const [lo, hi] = window(s, x, epsilon, m_keys.size());
+    auto const i = sorted_layout::lower_bound(m_keys.data() + lo, hi - lo, x);
+    return i == no_slot? hi : lo + i;
+  }
+
+  // The positions, of n in the level below, around the prediction of
+  // segment s for x: one more on each side than the bound, for the rounding.
+  auto window(size_t s, T const& x, size_t eps, size_t n) const -> std::pair<size_t, size_t> {
+    auto const& seg = m_segments[s];
+    auto const end = m_segments[s + 1].intercept;
+    auto const p = double(seg.intercept) + seg.slope * (double(x) - double(seg.key));
+    auto const pos = size_t(std::min(p, double(end)));
+    auto const lo = pos > eps + 1? pos - eps - 1 : 0;
+    auto const hi = std::min(pos + eps + 2, n);
+    return {lo, hi};
+  }
+
+  auto level_keys(size_t first, size_t count) const -> std::vector<T> {
+    auto keys = std::vector<T>(count);
+    for (auto i = size_t{0}; i < count; ++i) keys[i] = m_segments[first + i].key;
+    return keys;
+  }
+
+  // Appends the segments predicting the rank of each of the n keys within
+  // eps, and a sentinel. Returns the number of segments.
+  auto build(T const* keys, size_t n, size_t eps) -> size_t {
+    auto const first = m_segments.size();
+    auto start = size_t{0};
+    auto lo = 0.0, hi = std::numeric_limits<double>::infinity();
+    for (auto i = size_t{1}; i <= n; ++i) {
+      if (i < n) {
+        auto const dx = double(keys[i]) - double(keys[start]);
+        auto const dy = double(i - start);
+        auto const l = std::max(lo, (dy - double(eps)) / dx);
+        auto const h = std::min(hi, (dy + double(eps)) / dx);
+        if (l <= h) {
+          lo = l;
+          hi = h;
+          continue;
+        }
+      }
+      auto const slope = hi == std::numeric_limits<double>::infinity()? 0.0 : (lo + hi) / 2;
+      m_segments.push_back(segment{keys[start], start, slope});
+      start = i;
+      lo = 0.0;
+      hi = std::numeric_limits<double>::infinity();
+    }
+    m_segments.push_back(segment{std::numeric_limits<T>::max(), n, 0.0});
+    return m_segments.size() - first - 1;
+  }
+
+  static_detail::aligned_vector<T> m_keys;
+  std::vector<segment> m_segments;
+  std::vector<size_t> m_levels;
+};
+
+} /* end namespace benchunion */
+
+#endif
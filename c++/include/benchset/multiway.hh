@@ -0,0 +1,153 @@
+#ifndef BENCH_MULTIWAY_HH_
+#define BENCH_MULTIWAY_HH_
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <vector>
+#include "benchset/adaptive_intersection.hh"
+
+// Union and intersection of k sorted vectors in one pass, into one output,
+// instead of k - 1 pairwise passes each allocating a temporary.
+namespace benchunion {
+
+// Tournament tree over k sorted sequences: the internal nodes keep the loser
+// of the match played there and node 0 the overall winner, so replacing the
+// winner's head replays only the log2(k) matches on its path to the root.
+template<typename T>
+class loser_tree {
+ public:
+  explicit loser_tree(std::vector<std::vector<T>> const& sets)
+    : m_k(sets.size()), m_tree(std::max<size_t>(m_k, 1)),
+      m_heads(m_k), m_ends(m_k), m_keys(m_k), m_done(m_k) {
+    for (auto i = size_t{0}; i < m_k; ++i) {
+      m_heads[i] = sets[i].data();
+      m_ends[i] = sets[i].data() + sets[i].size();
+      load(i);
+    }
+    // Leaves are nodes k..2k-1 of an implicit heap; play the matches bottom up.
+    auto winners = std::vector<size_t>(2 * m_k);
+    for (auto i = size_t{0}; i < m_k; ++i) winners[m_k + i] = i;
+    for (auto n = m_k; n-- > 1;) {
+      auto const a = winners[2 * n], b = winners[2 * n + 1];
+      winners[n] = beats(a, b)? a : b;
+      m_tree[n] = beats(a, b)? b : a;
+    }
+    if (m_k > 0) m_tree[0] = winners[1];
+  }
+
+  // True once every sequence is exhausted.
+  auto empty() const -> bool { return m_k == 0 || m_done[m_tree[0]]; }
+
+  auto top() const -> T const& { return m_keys[m_tree[0]]; }
+
+  // Advances the winning sequence and replays its path. The outcome of the
+  // matches is unpredictable, so they select instead of branching.
+  auto pop() -> void {
+    auto w = m_tree[0];
+    ++m_heads[w];
+    load(w);
+    for (auto n = (w + m_k) / 2; n > 0; n /= 2) {
+      auto const l = m_tree[n];
+      auto const lost = beats(l, w);
+      m_tree[n] = lost? w : l;
+      w = lost? l : w;
+    }
+    m_tree[0] = w;
+  }
+
+ private:
+  // Caches the head of sequence i next to the others.
+  auto load(size_t i) -> void {
+    m_done[i] = m_heads[i] == m_ends[i];
+    if (!m_done[i]) m_keys[i] = *m_heads[i];
+  }
+
+  auto beats(size_t a, size_t b) const -> bool {
+    return bool(!m_done[a]) & (bool(m_done[b]) | (m_keys[a] < m_keys[b]));
+  }
+
+  size_t m_k;
+  std::vector<size_t> m_tree;
+  std::vector<T const*> m_heads;
+  std::vector<T const*> m_ends;
+  std::vector<T> m_keys;
+  std::vector<uint8_t> m_done;
+};
+
+// Writes the union of the sorted sets into 'out', replacing its contents.
+template<typename T>
+auto vectorset_union_into(std::vector<std::vector<T>> const& sets, std::vector<T>& out) -> void {
+  out.clear();
+  out.reserve(std::accumulate(sets.begin(), sets.end(), size_t{0},
+                              [](size_t n, auto const& s) { return n + s.size(); }));
+  for (auto tree = loser_tree<T>(sets); !tree.empty(); tree.pop())
+    if (out.empty() || out.back() < tree.top()) out.push_back(tree.top());
+}
+
+template<typename T>
+auto vectorset_union(std::vector<std::vector<T>> const& sets) -> std::vector<T> {
+  auto u = std::vector<T>{};
+  vectorset_union_into(sets, u);
+  return u;
+}
+
+// vectorset_intersection_adaptive of xs, the smaller, and ys, into the empty
+// 'out' without giving up its buffer.
+template<typename T>
+auto intersection_of_two_into(std::vector<T> const& xs, std::vector<T> const& ys, std::vector<T>& out) -> void {
+  if constexpr (simd::detail::is_word<T>) {
+    if (xs.size() * simd_galloping_ratio >= ys.size()) {
+      out.resize(xs.size() + simd::slack);
+      out.resize(simd::intersect(xs.data(), xs.size(), ys.data(), ys.size(), out.data()));
+      return;
+    }
+  }
+  out.reserve(xs.size());
+  adaptive_intersection(xs.begin(), xs.end(), ys.begin(), ys.end(), std::back_inserter(out));
+}
+
+// Writes the intersection of the sorted sets into 'out', replacing its
+// contents, in its own storage. Smallest sets first: the two smallest are
+// intersected as by vectorset_intersection_adaptive, then the candidates are
+// filtered in place through each of the larger sets, galloping from one
+// candidate to the next.
+template<typename T>
+auto vectorset_intersection_into(std::vector<std::vector<T>> const& sets, std::vector<T>& out) -> void {
+  out.clear();
+  if (sets.empty()) return;
+
+  auto order = std::vector<std::vector<T> const*>{};
+  for (auto const& s : sets) order.push_back(&s);
+  std::sort(order.begin(), order.end(), [](auto* a, auto* b) { return a->size() < b->size(); });
+
+  if (order.size() == 1) {
+    out.assign(order[0]->begin(), order[0]->end());
+    return;
+  }
+  intersection_of_two_into(*order[0], *order[1], out);
+
+  for (auto j = size_t{2}; j < order.size() && !out.empty(); ++j) {
+    auto it = order[j]->begin();
+    auto const end = order[j]->end();
+    auto kept = out.begin();
+    for (auto const& x : out) {
+      it = gallop_lower_bound(it, end, x);
+      if (it == end) break;
+      if (!(x < *it)) *kept++ = x;
+    }
+    out.erase(kept, out.end());
+  }
+}
+
+template<typename T>
+auto vectorset_intersection(std::vector<std::vector<T>> const& sets) -> std::vector<T> {
+  auto inter = std::vector<T>{};
+  vectorset_intersection_into(sets, inter);
+  return inter;
+}
+
+} /* end namespace benchunion */
+
+#endif
@@ -8,18 +8,25 @@
 #include <utility>
 #include <iterator>
 #include <initializer_list>
+#include <memory>
+#include "benchset/batch_search.hh"
 
 namespace my {
 
-template<typename T>
-using vector = std::vector<T>;
+template<typename T, typename Alloc = std::allocator<T>>
+using vector = std::vector<T, Alloc>;
+
+/** Tag for the constructors adopting a vector already sorted and without duplicates. */
+struct ordered_unique_range_t {};
+inline constexpr ordered_unique_range_t ordered_unique_range{};
 
 /** A sorted vector used for ordered sets, multisets, maps, multimaps. */
-template<typename T>
+template<typename T, typename Alloc = std::allocator<T>>
 class flat_tree {
  public:
   using value_type = T;
-  using vector_type = vector<T>;
+  using allocator_type = Alloc;
+  using vector_type = vector<T, Alloc>;
   using size_type = size_t;
   using pointer = value_type*;
   using const_pointer = value_type const*;
@@ -30,6 +37,9 @@ class flat_tree {
   using reverse_iterator = typename vector_type::const_reverse_iterator;
   using const_reverse_iterator = typename vector_type::const_reverse_iterator;
 
+  /** Returns the allocator of the underlying vector. */
+  auto get_allocator() const noexcept -> allocator_type { return m_vals.get_allocator(); }
+
   /** Returns whether the container is empty. */
   auto empty() const noexcept -> bool { return m_vals.empty(); }
 
@@ -66,34 +76,192 @@ class flat_tree {
   auto rend() const noexcept -> const_reverse_iterator { return m_vals.rend(); }
   auto crend() const noexcept -> const_reverse_iterator { return m_vals.rend(); }
 
+  /** Removes the element at pos; returns the iterator to the one after it. */
+  auto erase(const_iterator pos) -> iterator { return m_vals.erase(pos); }
+
+  /** Removes the elements of [first, last); returns the iterator to the one after them. */
+  auto erase(const_iterator first, const_iterator last) -> iterator { return m_vals.erase(first, last); }
+
+  /** Removes the elements satisfying 'pred', in one pass; returns how many were removed. */
+  template<typename Pred>
+  auto erase_if(Pred pred) -> size_type {
+    auto const end = std::remove_if(m_vals.begin(), m_vals.end(), pred);
+    auto const n = size_type(m_vals.end() - end);
+    m_vals.erase(end, m_vals.end());
+    return n;
+  }
+
  protected:
+  flat_tree() = default;
+  explicit flat_tree(allocator_type const& alloc) : m_vals(alloc) {}
+  explicit flat_tree(vector_type&& vals) : m_vals(std::move(vals)) {}
+
+  /**
+   * Appends [first, last), sorts and dedupes the new elements, then merges
+   * them with the old ones: O(n + m log m) instead of m inserts in the
+   * middle. Of equivalent elements, the first one stays, old ones first.
+   */
+  template<typename It, typename Less>
+  auto merge_unique(It first, It last, Less less) -> void {
+    auto const n = m_vals.size();
+    m_vals.insert(m_vals.end(), first, last);
+    auto const mid = m_vals.begin() + n;
+    auto const equiv = [&less](T const& a, T const& b) { return !less(a, b) && !less(b, a); };
+    std::stable_sort(mid, m_vals.end(), less);
+    auto end = std::unique(mid, m_vals.end(), equiv);
+    if (n > 0 && mid != end && less(*mid, *std::prev(mid))) {
+      std::inplace_merge(m_vals.begin(), mid, end, less);
+      end = std::unique(m_vals.begin(), end, equiv);
+    } else if (n > 0 && mid != end && !less(*std::prev(mid), *mid)) {
+      end = std::unique(std::prev(mid), end, equiv);
+    }
+    m_vals.erase(end, m_vals.end());
+  }
+
+  /**
+   * Merges in the sorted range [first, last) without duplicates: the vector
+   * grows to the size of the union, then is filled from the back, so each
+   * element moves at most once. Of equivalent elements, the old one stays.
+   */
+  template<typename It, typename Less>
+  auto merge_sorted(It first, It last, Less less) -> void {
+    auto i = m_vals.size();
+    auto k = i;
+    for (auto x = m_vals.begin(), y = first; y != last;) {
+      if (x != m_vals.end() && less(*x, *y)) {
+        ++x;
+      } else {
+        if (x == m_vals.end() || less(*y, *x)) ++k;
+        else ++x;
+        ++y;
+      }
+    }
+    m_vals.resize(k);
+    for (auto y = last; k != i;) {
+      if (i > 0 && less(*std::prev(y), m_vals[i - 1])) {
+        m_vals[--k] = std::move(m_vals[--i]);
+      } else {
+        if (i > 0 && !less(m_vals[i - 1], *std::prev(y))) m_vals[--k] = std::move(m_vals[--i]);
+        else m_vals[--k] = *std::prev(y);
+        --y;
+      }
+    }
+  }
+
+  /** Keeps the elements with an equivalent in the sorted range [first, last), in one pass. */
+  template<typename It, typename Less>
+  auto retain_sorted(It first, It last, Less less) -> void {
+    auto out = m_vals.begin();
+    for (auto x = m_vals.begin(); x != m_vals.end() && first != last;) {
+      if (less(*x, *first)) {
+        ++x;
+      } else {
+        if (!less(*first, *x)) {
+          if (out != x) *out = std::move(*x);
+          ++out;
+          ++x;
+        }
+        ++first;
+      }
+    }
+    m_vals.erase(out, m_vals.end());
+  }
+
+  /**
+   * Removes the elements whose key, by 'key_of', is in the sorted range
+   * [first, last), in one pass starting at the first of them: the elements
+   * kept move at most once. Returns how many were removed.
+   */
+  template<typename It, typename KeyOf>
+  auto remove_sorted(It first, It last, KeyOf key_of) -> size_type {
+    if (first == last) return 0;
+    auto x = std::partition_point(m_vals.begin(), m_vals.end(), [&](T const& v) { return key_of(v) < *first; });
+    auto out = x;
+    for (; x != m_vals.end() && first != last; ++x) {
+      while (first != last && *first < key_of(*x)) ++first;
+      if (first != last && !(key_of(*x) < *first)) continue;
+      if (out != x) *out = std::move(*x);
+      ++out;
+    }
+    if (out != x) out = std::move(x, m_vals.end(), out);
+    else out = m_vals.end();
+    auto const n = size_type(m_vals.end() - out);
+    m_vals.erase(out, m_vals.end());
+    return n;
+  }
+
   vector_type m_vals;
 };
 
-template<typename Key>
-struct flat_set : public flat_tree<Key> {
+template<typename Key, typename Alloc = std::allocator<Key>>
+struct flat_set : public flat_tree<Key, Alloc> {
   using key_type = Key;
   using value_type = key_type;
-  using vector_type = vector<key_type>;
+  using allocator_type = Alloc;
+  using vector_type = vector<key_type, Alloc>;
   using size_type = size_t;
   using difference_type = ptrdiff_t;
   using pointer = key_type*;
   using const_pointer = key_type const*;
   using reference = key_type&;
   using const_reference = key_type const&;
-  using iterator = typename flat_tree<Key>::iterator;
-  using const_iterator = typename flat_tree<Key>::const_iterator;
-  using reverse_iterator = typename flat_tree<Key>::const_reverse_iterator;
-  using const_reverse_iterator = typename flat_tree<Key>::const_reverse_iterator;
+  using iterator = typename flat_tree<Key, Alloc>::iterator;
+  using const_iterator = typename flat_tree<Key, Alloc>::const_iterator;
+  using reverse_iterator = typename flat_tree<Key, Alloc>::const_reverse_iterator;
+  using const_reverse_iterator = typename flat_tree<Key, Alloc>::const_reverse_iterator;
 
-  flat_set(std::initializer_list<key_type> const& keys) {
-    for (auto const& key : keys) insert(key);
+  flat_set() = default;
+
+  explicit flat_set(allocator_type const& alloc) : flat_tree<Key, Alloc>(alloc) {}
+
+  flat_set(std::initializer_list<key_type> const& keys, allocator_type const& alloc = allocator_type())
+      : flat_tree<Key, Alloc>(alloc) {
+    insert_range(keys.begin(), keys.end());
+  }
+
+  template<typename It>
+  flat_set(It first, It last, allocator_type const& alloc = allocator_type()) : flat_tree<Key, Alloc>(alloc) {
+    insert_range(first, last);
+  }
+
+  /** Adopts 'keys', which must be sorted and without duplicates, with their allocator. */
+  flat_set(ordered_unique_range_t, vector_type keys) : flat_tree<Key, Alloc>(std::move(keys)) {}
+
+  /** Inserts the keys of [first, last), in any order. */
+  template<typename It>
+  auto insert_range(It first, It last) -> void { this->merge_unique(first, last, std::less<>{}); }
+
+  /** Adds the keys of 'other'. */
+  auto operator|=(flat_set const& other) -> flat_set& {
+    this->merge_sorted(other.begin(), other.end(), std::less<>{});
+    return *this;
+  }
+
+  /** Keeps only the keys also in 'other'. */
+  auto operator&=(flat_set const& other) -> flat_set& {
+    this->retain_sorted(other.begin(), other.end(), std::less<>{});
+    return *this;
   }
 
-  auto find(key_type const& k) const noexcept -> const_iterator {
+  /**
+   * Finds k, which can be of any type ordered against key_type, like a
+   * std::string_view for std::string keys, without converting it.
+   */
+  template<typename K = key_type>
+  auto find(K const& k) const noexcept -> const_iterator {
     if (this->empty()) return this->end();
     auto const i = std::lower_bound(this->m_vals.begin(), this->m_vals.end(), k);
-    return *i == k? i : this->end();
+    return i != this->end() && *i == k? i : this->end();
+  }
+
+  /** Writes find(k) to 'out' for each key k of [first, last), interleaving the searches. */
+  template<typename KeyIt, typename OutIt>
+  auto find_batch(KeyIt first, KeyIt last, OutIt out) const -> OutIt {
+    benchunion::lower_bound_batch(this->data(), this->size(), first, last, std::less<>{},
+      [&](auto const& k, size_t i) {
+        *out++ = i < this->size() && this->m_vals[i] == k? this->begin() + i : this->end();
+      });
+    return out;
   }
 
   auto insert(key_type const& k) {
@@ -104,32 +272,54 @@ struct flat_set : public flat_tree<Key> {
     auto const i = std::lower_bound(this->m_vals.begin(), this->m_vals.end(), k);
     if (*i != k) this->m_vals.insert(i, k);
   }
+
+  using flat_tree<Key, Alloc>::erase;
+
+  /** Removes k, if present; returns how many keys were removed. */
+  template<typename K = key_type>
+  auto erase(K const& k) -> size_type {
+    auto const r = std::equal_range(this->m_vals.begin(), this->m_vals.end(), k);
+    auto const n = size_type(r.second - r.first);
+    this->m_vals.erase(r.first, r.second);
+    return n;
+  }
+
+  /** Removes the keys of the sorted range [first, last), in one pass; returns how many were removed. */
+  template<typename It>
+  auto erase_sorted(It first, It last) -> size_type {
+    return this->remove_sorted(first, last, [](key_type const& k) -> key_type const& { return k; });
+  }
 };
 
-template<typename Key>
-struct flat_multiset : public flat_tree<Key> {
+template<typename Key, typename Alloc = std::allocator<Key>>
+struct flat_multiset : public flat_tree<Key, Alloc> {
   using key_type = Key;
   using value_type = key_type;
-  using vector_type = vector<key_type>;
+  using allocator_type = Alloc;
+  using vector_type = vector<key_type, Alloc>;
   using size_type = size_t;
   using difference_type = ptrdiff_t;
   using pointer = key_type*;
   using const_pointer = key_type const*;
   using reference = key_type&;
   using const_reference = key_type const&;
-  using iterator = typename flat_tree<Key>::iterator;
-  using const_iterator = typename flat_tree<Key>::const_iterator;
-  using reverse_iterator = typename flat_tree<Key>::const_reverse_iterator;
-  using const_reverse_iterator = typename flat_tree<Key>::const_reverse_iterator;
+  using iterator = typename flat_tree<Key, Alloc>::iterator;
+  using const_iterator = typename flat_tree<Key, Alloc>::const_iterator;
+  using reverse_iterator = typename flat_tree<Key, Alloc>::const_reverse_iterator;
+  using const_reverse_iterator = typename flat_tree<Key, Alloc>::const_reverse_iterator;
+
+  explicit flat_multiset(allocator_type const& alloc) : flat_tree<Key, Alloc>(alloc) {}
 
-  flat_multiset(std::initializer_list<Key> const& keys) {
+  flat_multiset(std::initializer_list<Key> const& keys, allocator_type const& alloc = allocator_type())
+      : flat_tree<Key, Alloc>(alloc) {
     for (auto const& key : keys) insert(key);
   }
 
-  auto find(Key const& k) const noexcept -> const_iterator {
+  template<typename K = key_type>
+  auto find(K const& k) const noexcept -> const_iterator {
     if (this->empty()) return this->end();
     auto const i = std::lower_bound(this->m_vals.begin(), this->m_vals.end(), k);
-    return *i == k? i : this->end();
+    return i != this->end() && *i == k? i : this->end();
   }
 
   auto insert(Key const& k) {
@@ -140,6 +330,23 @@ struct flat_multiset : public flat_tree<Key> {
     auto const i = std::lower_bound(this->m_vals.begin(), this->m_vals.end(), k);
     this->m_vals.insert(i, k);
   }
+
+  using flat_tree<Key, Alloc>::erase;
+
+  /** Removes every copy of k; returns how many were removed. */
+  template<typename K = key_type>
+  auto erase(K const& k) -> size_type {
+    auto const r = std::equal_range(this->m_vals.begin(), this->m_vals.end(), k);
+    auto const n = size_type(r.second - r.first);
+    this->m_vals.erase(r.first, r.second);
+    return n;
+  }
+
+  /** Removes every copy of the keys of the sorted range [first, last), in one pass. */
+  template<typename It>
+  auto erase_sorted(It first, It last) -> size_type {
+    return this->remove_sorted(first, last, [](key_type const& k) -> key_type const& { return k; });
+  }
 };
 
 template<typename Key, typename Value>
@@ -165,12 +372,13 @@ auto key_lower_bound(ForwardIt fst, ForwardIt lst, T const& value) -> ForwardIt
   return fst;
 }
 
-template<typename Key, typename Value>
-struct flat_map : public flat_tree<pair<Key, Value>> {
+template<typename Key, typename Value, typename Alloc = std::allocator<pair<Key, Value>>>
+struct flat_map : public flat_tree<pair<Key, Value>, Alloc> {
   using key_type = Key;
   using mapped_type = Value;
   using value_type = pair<key_type, mapped_type>;
-  using vector_type = vector<value_type>;
+  using allocator_type = Alloc;
+  using vector_type = vector<value_type, Alloc>;
   using size_type = size_t;
   using difference_type = ptrdiff_t;
   using pointer = value_type*;
@@ -178,19 +386,72 @@ struct flat_map : public flat_tree<pair<Key, Value>> {
   using reference = value_type&;
   using const_reference = value_type const&;
   using mapped_type_reference = mapped_type&;
-  using iterator = typename flat_tree<value_type>::iterator;
-  using const_iterator = typename flat_tree<value_type>::const_iterator;
-  using reverse_iterator = typename flat_tree<value_type>::const_reverse_iterator;
-  using const_reverse_iterator = typename flat_tree<value_type>::const_reverse_iterator;
+  using iterator = typename flat_tree<value_type, Alloc>::iterator;
+  using const_iterator = typename flat_tree<value_type, Alloc>::const_iterator;
+  using reverse_iterator = typename flat_tree<value_type, Alloc>::const_reverse_iterator;
+  using const_reverse_iterator = typename flat_tree<value_type, Alloc>::const_reverse_iterator;
 
-  flat_map(std::initializer_list<value_type> const& ps) {
-    for (auto const& p : ps) insert(p);
+  /** Orders the pairs by key only. */
+  static constexpr auto key_less = [](value_type const& a, value_type const& b) { return a.first < b.first; };
+
+  flat_map() = default;
+
+  explicit flat_map(allocator_type const& alloc) : flat_tree<value_type, Alloc>(alloc) {}
+
+  flat_map(std::initializer_list<value_type> const& ps, allocator_type const& alloc = allocator_type())
+      : flat_tree<value_type, Alloc>(alloc) {
+    insert_range(ps.begin(), ps.end());
+  }
+
+  template<typename It>
+  flat_map(It first, It last, allocator_type const& alloc = allocator_type())
+      : flat_tree<value_type, Alloc>(alloc) {
+    insert_range(first, last);
+  }
+
+  /** Adopts 'ps', which must be sorted by key and without duplicate keys, with their allocator. */
+  flat_map(ordered_unique_range_t, vector_type ps) : flat_tree<value_type, Alloc>(std::move(ps)) {}
+
+  /**
+   * Inserts the pairs of [first, last), in any order. Like insert, a pair
+   * whose key is already present is dropped.
+   */
+  template<typename It>
+  auto insert_range(It first, It last) -> void { this->merge_unique(first, last, key_less); }
+
+  /** Adds the pairs of 'other' whose key is missing. */
+  auto operator|=(flat_map const& other) -> flat_map& {
+    this->merge_sorted(other.begin(), other.end(), key_less);
+    return *this;
   }
 
-  auto find(key_type const& k) const noexcept -> iterator {
+  /** Keeps only the pairs whose key is also in 'other'. */
+  auto operator&=(flat_map const& other) -> flat_map& {
+    this->retain_sorted(other.begin(), other.end(), key_less);
+    return *this;
+  }
+
+  /**
+   * Finds the pair of key k, which can be of any type ordered against
+   * key_type, like a std::string_view for std::string keys, without
+   * converting it.
+   */
+  template<typename K = key_type>
+  auto find(K const& k) const noexcept -> iterator {
     if (this->empty()) return this->end();
     auto const i = key_lower_bound(this->m_vals.begin(), this->m_vals.end(), k);
-    return i->first == k? i : this->end();
+    return i != this->end() && i->first == k? i : this->end();
+  }
+
+  /** Writes find(k) to 'out' for each key k of [first, last), interleaving the searches. */
+  template<typename KeyIt, typename OutIt>
+  auto find_batch(KeyIt first, KeyIt last, OutIt out) const -> OutIt {
+    auto const less = [](value_type const& p, auto const& k) { return p.first < k; };
+    benchunion::lower_bound_batch(this->data(), this->size(), first, last, less,
+      [&](auto const& k, size_t i) {
+        *out++ = i < this->size() && this->m_vals[i].first == k? this->begin() + i : this->end();
+      });
+    return out;
   }
 
   auto insert(value_type const& p) -> pair<iterator, bool> {
@@ -206,23 +467,43 @@ struct flat_map : public flat_tree<pair<Key, Value>> {
     return pair<iterator, bool>(this->m_vals.end(), false);
   }
 
-  auto operator[](key_type const& k) -> mapped_type_reference {
+  /** Like find, k is only converted to key_type when it is inserted. */
+  template<typename K = key_type>
+  auto operator[](K const& k) -> mapped_type_reference {
     auto const i = key_lower_bound(this->m_vals.begin(), this->m_vals.end(), k);
     if (i == this->m_vals.end() || i->first != k) {
-      value_type p(k, mapped_type());
+      value_type p{key_type(k), mapped_type()};
       auto const j = this->m_vals.insert(i, p);
       return std::get<1>(*j);
     }
     return std::get<1>(*i);
   }
+
+  using flat_tree<value_type, Alloc>::erase;
+
+  /** Removes the pair of key k, if present; returns how many pairs were removed. */
+  template<typename K = key_type>
+  auto erase(K const& k) -> size_type {
+    auto const i = key_lower_bound(this->m_vals.begin(), this->m_vals.end(), k);
+    if (i == this->m_vals.end() || i->first != k) return 0;
+    this->m_vals.erase(i);
+    return 1;
+  }
+
+  /** Removes the pairs with a key in the sorted range [first, last), in one pass; returns how many were removed. */
+  template<typename It>
+  auto erase_sorted(It first, It last) -> size_type {
+    return this->remove_sorted(first, last, [](value_type const& p) -> key_type const& { return p.first; });
+  }
 };
 
-template<typename Key, typename Value>
-struct flat_multimap : public flat_tree<pair<Key, Value>> {
+template<typename Key, typename Value, typename Alloc = std::allocator<pair<Key, Value>>>
+struct flat_multimap : public flat_tree<pair<Key, Value>, Alloc> {
   using key_type = Key;
   using mapped_type = Value;
   using value_type = pair<key_type, mapped_type>;
-  using vector_type = vector<value_type>;
+  using allocator_type = Alloc;
+  using vector_type = vector<value_type, Alloc>;
   using size_type = size_t;
   using difference_type = ptrdiff_t;
   using pointer = value_type*;
@@ -230,19 +511,23 @@ struct flat_multimap : public flat_tree<pair<Key, Value>> {
   using reference = value_type&;
   using const_reference = value_type const&;
   using mapped_type_reference = mapped_type&;
-  using iterator = typename flat_tree<value_type>::iterator;
-  using const_iterator = typename flat_tree<value_type>::const_iterator;
-  using reverse_iterator = typename flat_tree<value_type>::const_reverse_iterator;
-  using const_reverse_iterator = typename flat_tree<value_type>::const_reverse_iterator;
+  using iterator = typename flat_tree<value_type, Alloc>::iterator;
+  using const_iterator = typename flat_tree<value_type, Alloc>::const_iterator;
+  using reverse_iterator = typename flat_tree<value_type, Alloc>::const_reverse_iterator;
+  using const_reverse_iterator = typename flat_tree<value_type, Alloc>::const_reverse_iterator;
+
+  explicit flat_multimap(allocator_type const& alloc) : flat_tree<value_type, Alloc>(alloc) {}
 
-  flat_multimap(std::initializer_list<value_type> const& ps) {
+  flat_multimap(std::initializer_list<value_type> const& ps, allocator_type const& alloc = allocator_type())
+      : flat_tree<value_type, Alloc>(alloc) {
     for (auto const& p : ps) insert(p);
   }
 
-  auto find(key_type const& k) const noexcept -> iterator {
+  template<typename K = key_type>
+  auto find(K const& k) const noexcept -> iterator {
     if (this->empty()) return this->end();
     auto const i = key_lower_bound(this->m_vals.begin(), this->m_vals.end(), k);
-    return i->first == k? i : this->end();
+    return i != this->end() && i->first == k? i : this->end();
   }
 
   auto insert(value_type const& p) -> pair<iterator, bool> {
@@ -256,15 +541,34 @@ struct flat_multimap : public flat_tree<pair<Key, Value>> {
   }
 
   // Check if this is how std::multimap behaves (modifying existing if possible).
-  auto operator[](key_type const& k) -> mapped_type_reference {
+  template<typename K = key_type>
+  auto operator[](K const& k) -> mapped_type_reference {
     auto const i = key_lower_bound(this->m_vals.begin(), this->m_vals.end(), k);
     if (i == this->m_vals.end() || i->first != k) {
-      value_type p(k, mapped_type());
+      value_type p{key_type(k), mapped_type()};
       auto const j = this->m_vals.insert(i, p);
       return std::get<1>(*j);
     }
     return std::get<1>(*i);
   }
+
+  using flat_tree<value_type, Alloc>::erase;
+
+  /** Removes every pair of key k; returns how many were removed. */
+  template<typename K = key_type>
+  auto erase(K const& k) -> size_type {
+    auto const i = key_lower_bound(this->m_vals.begin(), this->m_vals.end(), k);
+    auto const j = std::partition_point(i, this->m_vals.end(), [&](value_type const& p) { return !(k < p.first); });
+    auto const n = size_type(j - i);
+    this->m_vals.erase(i, j);
+    return n;
+  }
+
+  /** Removes every pair whose key is in the sorted range [first, last), in one pass. */
+  template<typename It>
+  auto erase_sorted(It first, It last) -> size_type {
+    return this->remove_sorted(first, last, [](value_type const& p) -> key_type const& { return p.first; });
+  }
 };
 
 } /* end namespace my */
@@ -0,0 +1,401 @@
+#ifndef BENCH_PACKED_SET_HH_
+#define BENCH_PACKED_SET_HH_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "benchset/simd_intersection.hh"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// A sorted set of 32-bit integers, compressed. The elements are cut into
+// blocks of 128; a block stores the gaps between its elements, minus one,
+// with as many bits each as the widest needs (binary packing, as in
+// SIMD-BP128). The gaps are interleaved over 4 lanes of 32-bit words, so
+// that decoding shifts and masks 4 at a time and the 4 decoded are
+// consecutive elements, summed up with two vector shifts.
+//
+// The first and last elements of every block are kept apart, uncompressed:
+// they are the skip pointers a find binary searches before decoding one
+// block, and let union and intersection pass over blocks whose range does
+// not meet the other set.
+namespace benchunion {
+
+namespace packed_detail {
+
+constexpr size_t block = 128;
+constexpr size_t lanes = 4;
+
+// The order of T as the order of unsigned integers.
+template<typename T>
+constexpr uint32_t flip = std::is_signed_v<T>? 0x80000000u : 0u;
+
+inline auto width(uint32_t x) -> unsigned { return x == 0? 0 : 32 - unsigned(__builtin_clz(x)); }
+
+// Packs the 128 gaps in 4 * B words: gap i goes to lane i % 4, at bit
+// (i / 4) * B of that lane, so 4 consecutive gaps are packed at once.
+template<unsigned B>
+auto pack_fixed(uint32_t const* gaps, uint32_t* words) -> void {
+  std::fill(words, words + lanes * B, 0u);
+  if constexpr (B != 0) {
+#ifdef __SSE2__
+    auto* const w = reinterpret_cast<__m128i*>(words);
+#pragma GCC unroll 32
+    for (auto j = size_t{0}; j < block / lanes; ++j) {
+      auto const bit = j * B;
+      auto const s = int(bit % 32);
+      auto const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(gaps + lanes * j));
+      auto* const out = w + bit / 32;
+      _mm_storeu_si128(out, _mm_or_si128(_mm_loadu_si128(out), _mm_slli_epi32(v, s)));
+      if (s + int(B) > 32)
+        _mm_storeu_si128(out + 1, _mm_or_si128(_mm_loadu_si128(out + 1), _mm_srli_epi32(v, 32 - s)));
+    }
+#else
+    for (auto i = size_t{0}; i < block; ++i) {
+      auto const bit = (i / lanes) * B;
+      auto* const w = words + lanes * (bit / 32) + i % lanes;
+      auto const s = bit % 32;
+      w[0] |= gaps[i] << s;
+      if (s + B > 32) w[lanes] |= gaps[i] >> (32 - s);
+    }
+#endif
+  }
+}
+
+// Decodes a block packed with B bits into 128 elements, the first being
+// 'first', as elements of T. With B known, the loop unrolls into constant
+// shifts.
+template<unsigned B, typename T>
+auto unpack_fixed(uint32_t const* words, uint32_t first, T* out) -> void {
+  constexpr auto mask = B == 32? ~0u : (1u << B) - 1;
+#ifdef __SSE2__
+  auto const vmask = _mm_set1_epi32(int(mask));
+  auto const one = _mm_set1_epi32(1);
+  auto const sign = _mm_set1_epi32(int(flip<T>));
+  auto acc = _mm_set1_epi32(int(first - 1));
+  auto const* const w = reinterpret_cast<__m128i const*>(words);
+#pragma GCC unroll 32
+  for (auto j = size_t{0}; j < block / lanes; ++j) {
+    auto v = _mm_setzero_si128();
+    if constexpr (B != 0) {
+      auto const bit = j * B;
+      auto const s = int(bit % 32);
+      v = _mm_srli_epi32(_mm_loadu_si128(w + bit / 32), s);
+      if (s + int(B) > 32) v = _mm_or_si128(v, _mm_slli_epi32(_mm_loadu_si128(w + bit / 32 + 1), 32 - s));
+      v = _mm_and_si128(v, vmask);
+    }
+    v = _mm_add_epi32(v, one);
+    v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+    v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+    v = _mm_add_epi32(v, acc);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + lanes * j), _mm_xor_si128(v, sign));
+    acc = _mm_shuffle_epi32(v, 0xff);
+  }
+#else
+  auto x = first - 1;
+  for (auto i = size_t{0}; i < block; ++i) {
+    auto g = 0u;
+    if constexpr (B != 0) {
+      auto const bit = (i / lanes) * B;
+      auto const* const w = words + lanes * (bit / 32) + i % lanes;
+      auto const s = bit % 32;
+      g = w[0] >> s;
+      if (s + B > 32) g |= w[lanes] << (32 - s);
+    }
+    x += (g & mask) + 1;
+    out[i] = T(x ^ flip<T>);
+  }
+#endif
+}
+
+template<typename T, unsigned... B>
+constexpr auto unpackers(std::integer_sequence<unsigned, B...>) {
+  using unpacker = void (*)(uint32_t const*, uint32_t, T*);
+  return std::array<unpacker, sizeof...(B)>{&unpack_fixed<B, T>...};
+}
+
+template<unsigned... B>
+constexpr auto packers(std::integer_sequence<unsigned, B...>) {
+  using packer = void (*)(uint32_t const*, uint32_t*);
+  return std::array<packer, sizeof...(B)>{&pack_fixed<B>...};
+}
+
+// Packs and decodes blocks of b bits, through the functions for b.
+inline auto pack(uint32_t const* gaps, unsigned b, uint32_t* words) -> void {
+  static constexpr auto table = packers(std::make_integer_sequence<unsigned, 33>{});
+  table[b](gaps, words);
+}
+
+template<typename T>
+auto unpack(uint32_t const* words, unsigned b, uint32_t first, T* out) -> void {
+  static constexpr auto table = unpackers<T>(std::make_integer_sequence<unsigned, 33>{});
+  table[b](words, first, out);
+}
+
+} /* end namespace packed_detail */
+
+template<typename T>
+class packed_set {
+  static_assert(simd::detail::is_word<T>, "packed sets hold 32-bit integers");
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+
+  static constexpr size_t block_size = packed_detail::block;
+
+  // Appends elements in increasing order, then makes the set.
+  class builder {
+   public:
+    // x must be greater than every element appended so far.
+    auto push_back(T x) -> void {
+      m_tail[m_count++] = x;
+      if (m_count == block_size) flush();
+    }
+
+    template<typename It>
+    auto append(It first, It last) -> void { for (; first != last; ++first) push_back(*first); }
+
+    // The elements of [first, last), increasing, copied a block at a time.
+    auto append(T const* first, T const* last) -> void {
+      while (first != last) {
+        auto const n = std::min(size_t(last - first), block_size - m_count);
+        std::copy(first, first + n, m_tail + m_count);
+        m_count += n;
+        first += n;
+        if (m_count == block_size) flush();
+      }
+    }
+
+    // Copies block i of 'xs', full and greater than everything appended, as
+    // it is compressed. Returns false, copying nothing, if the tail of the
+    // last block is not empty, as the blocks must stay aligned on 128.
+    auto append_block(packed_set const& xs, size_t i) -> bool {
+      if (m_count != 0 || xs.block_count(i) != block_size) return false;
+      auto const b = xs.m_widths[i];
+      auto const* const w = xs.m_words.data() + xs.m_offsets[i];
+      m_set.add_block(xs.m_firsts[i], xs.m_lasts[i], b, w);
+      m_set.m_size += block_size;
+      return true;
+    }
+
+    auto finish() -> packed_set {
+      flush();
+      return std::move(m_set);
+    }
+
+   private:
+    auto flush() -> void {
+      if (m_count == 0) return;
+      uint32_t gaps[block_size] = {};
+      auto any = 0u;
+      for (auto i = size_t{1}; i < m_count; ++i) {
+        gaps[i] = uint32_t(m_tail[i]) - uint32_t(m_tail[i - 1]) - 1;
+        any |= gaps[i];
+      }
+      auto const b = packed_detail::width(any);
+      uint32_t words[block_size];
+      packed_detail::pack(gaps, b, words);
+      m_set.add_block(m_tail[0], m_tail[m_count - 1], b, words);
+      m_set.m_size += m_count;
+      m_count = 0;
+    }
+
+    packed_set m_set;
+    T m_tail[block_size];
+    size_t m_count = 0;
+  };
+
+  packed_set() = default;
+
+  // Compresses [first, last), which must be sorted and without duplicates.
+  template<typename It>
+  packed_set(It first, It last) {
+    auto b = builder{};
+    b.append(first, last);
+    *this = b.finish();
+  }
+
+  auto empty() const noexcept -> bool { return m_size == 0; }
+  auto size() const noexcept -> size_type { return m_size; }
+
+  // Bytes held by the set, including the object itself.
+  auto bytes() const noexcept -> size_t {
+    return sizeof(*this) + m_words.capacity() * sizeof(uint32_t) + (m_firsts.capacity() + m_lasts.capacity()) * sizeof(T)
+      + m_offsets.capacity() * sizeof(uint32_t) + m_widths.capacity();
+  }
+
+  auto blocks() const noexcept -> size_t { return m_firsts.size(); }
+
+  // Elements of block i: 128, but for the last block.
+  auto block_count(size_t i) const noexcept -> size_t {
+    return i + 1 < blocks()? block_size : m_size - i * block_size;
+  }
+
+  // The first and last elements of block i.
+  auto block_first(size_t i) const noexcept -> T { return m_firsts[i]; }
+  auto block_last(size_t i) const noexcept -> T { return m_lasts[i]; }
+
+  // Decodes block i into 'out', which must have room for 128, and returns its count.
+  auto decode(size_t i, T* out) const -> size_t {
+    packed_detail::unpack(m_words.data() + m_offsets[i], m_widths[i],
+                          uint32_t(m_firsts[i]) ^ packed_detail::flip<T>, out);
+    return block_count(i);
+  }
+
+  auto contains(T x) const -> bool {
+    auto const i = std::upper_bound(m_firsts.begin(), m_firsts.end(), x) - m_firsts.begin();
+    if (i == 0 || m_lasts[i - 1] < x) return false;
+    T buf[block_size];
+    auto const n = decode(size_t(i - 1), buf);
+    return std::binary_search(buf, buf + n, x);
+  }
+
+  // Calls f on every element, in order.
+  template<typename F>
+  auto for_each(F f) const -> void {
+    T buf[block_size];
+    for (auto i = size_t{0}; i < blocks(); ++i) {
+      auto const n = decode(i, buf);
+      for (auto k = size_t{0}; k < n; ++k) f(buf[k]);
+    }
+  }
+
+  auto to_vector() const -> std::vector<T> {
+    auto v = std::vector<T>{};
+    v.reserve(m_size);
+    for_each([&v](T x) { v.push_back(x); });
+    return v;
+  }
+
+ private:
+  auto add_block(T first, T last, unsigned b, uint32_t const* words) -> void {
+    m_firsts.push_back(first);
+    m_lasts.push_back(last);
+    m_offsets.push_back(uint32_t(m_words.size()));
+    m_widths.push_back(uint8_t(b));
+    m_words.insert(m_words.end(), words, words + packed_detail::lanes * b);
+  }
+
+  std::vector<uint32_t> m_words;
+  std::vector<T> m_firsts;
+  std::vector<T> m_lasts;
+  std::vector<uint32_t> m_offsets;
+  std::vector<uint8_t> m_widths;
+  size_t m_size = 0;
+};
+
+namespace packed_detail {
+
+// Walks a packed set, decoding one block at a time.
+template<typename T>
+class cursor {
+ public:
+  explicit cursor(packed_set<T> const& xs) : m_xs(xs) { load(); }
+
+  auto done() const noexcept -> bool { return m_block == m_xs.blocks(); }
+  auto at_block_start() const noexcept -> bool { return m_pos == 0; }
+  auto block() const noexcept -> size_t { return m_block; }
+  auto value() const noexcept -> T { return m_buf[m_pos]; }
+
+  // The decoded elements of the block not passed yet.
+  auto first() const noexcept -> T const* { return m_buf + m_pos; }
+  auto last() const noexcept -> T const* { return m_buf + m_count; }
+
+  // Passes the elements up to p, within the block.
+  auto skip_to(T const* p) -> void {
+    m_pos = size_t(p - m_buf);
+    if (m_pos == m_count) next_block();
+  }
+
+  auto next_block() -> void {
+    ++m_block;
+    load();
+  }
+
+ private:
+  auto load() -> void {
+    m_pos = 0;
+    m_count = done()? 0 : m_xs.decode(m_block, m_buf);
+  }
+
+  packed_set<T> const& m_xs;
+  size_t m_block = 0;
+  size_t m_pos = 0;
+  size_t m_count = 0;
+  T m_buf[packed_set<T>::block_size];
+};
+
+} /* end namespace packed_detail */
+
+// Merges the decoded blocks until one of them runs out; a full block of one
+// set before the current element of the other is copied without decoding it
+// again.
+template<typename T>
+auto packedset_union(packed_set<T> const& xs, packed_set<T> const& ys) -> packed_set<T> {
+  auto out = typename packed_set<T>::builder{};
+  auto x = packed_detail::cursor<T>(xs);
+  auto y = packed_detail::cursor<T>(ys);
+  while (!x.done() && !y.done()) {
+    if (x.at_block_start() && xs.block_last(x.block()) < y.value() && out.append_block(xs, x.block())) {
+      x.next_block();
+      continue;
+    }
+    if (y.at_block_start() && ys.block_last(y.block()) < x.value() && out.append_block(ys, y.block())) {
+      y.next_block();
+      continue;
+    }
+    T merged[2 * packed_set<T>::block_size];
+    auto n = size_t{0};
+    auto px = x.first(), py = y.first();
+    auto const ex = x.last(), ey = y.last();
+    while (px != ex && py != ey) {
+      auto const a = *px, b = *py;
+      merged[n++] = b < a? b : a;
+      px += !(b < a);
+      py += !(a < b);
+    }
+    out.append(merged, merged + n);
+    x.skip_to(px);
+    y.skip_to(py);
+  }
+  for (auto* rest : {&x, &y}) {
+    auto const& zs = rest == &x? xs : ys;
+    while (!rest->done()) {
+      if (!rest->at_block_start() || !out.append_block(zs, rest->block())) out.append(rest->first(), rest->last());
+      rest->next_block();
+    }
+  }
+  return out.finish();
+}
+
+// Intersects the decoded blocks whose ranges meet, with the best kernel of
+// simd_intersection.hh; the others are not decoded.
+template<typename T>
+auto packedset_intersection(packed_set<T> const& xs, packed_set<T> const& ys) -> packed_set<T> {
+  auto out = typename packed_set<T>::builder{};
+  T bx[packed_set<T>::block_size], by[packed_set<T>::block_size], bz[packed_set<T>::block_size + simd::slack];
+  auto nx = size_t{0}, ny = size_t{0};
+  auto decoded_x = xs.blocks(), decoded_y = ys.blocks();
+  for (auto i = size_t{0}, j = size_t{0}; i < xs.blocks() && j < ys.blocks();) {
+    if (xs.block_last(i) < ys.block_first(j)) { ++i; continue; }
+    if (ys.block_last(j) < xs.block_first(i)) { ++j; continue; }
+    if (decoded_x != i) nx = xs.decode(decoded_x = i, bx);
+    if (decoded_y != j) ny = ys.decode(decoded_y = j, by);
+    auto const nz = simd::intersect(bx, nx, by, ny, bz);
+    out.append(bz, bz + nz);
+    if (xs.block_last(i) < ys.block_last(j)) ++i;
+    else ++j;
+  }
+  return out.finish();
+}
+
+} /* end namespace benchunion */
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef BENCH_PAR_SETOPS_HH_
+#define BENCH_PAR_SETOPS_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+#include "benchset/simd_union.hh"
+#include "par/pool.hh"
+
+// Union and intersection of large sorted vectors on the threads of a pool.
+// Merge-path partitioning (Odeh et al.) cuts the merge of xs and ys into
+// slices holding the same number of input elements; a first parallel pass
+// counts the output of each slice, and a second one writes every slice at
+// the offset the counts give. The result is the same as the serial
+// vectorset_union and vectorset_intersection, whatever the number of threads.
+namespace benchunion {
+
+namespace par_detail {
+
+// Smallest slice, in input elements, worth a task of its own.
+constexpr size_t min_slice = size_t{1} << 16;
+
+struct split {
+  size_t i, j;
+};
+
+// The split of the merge path on diagonal 'diag': xs[0, i) and ys[0, j),
+// i + j = diag, are the first diag elements of the merge of xs and ys, xs
+// first on ties.
+template<typename T>
+auto merge_path(T const* xs, size_t nx, T const* ys, size_t ny, size_t diag) -> split {
+  auto lo = diag > ny? diag - ny : 0, hi = std::min(diag, nx);
+  while (lo < hi) {
+    auto const i = lo + (hi - lo) / 2;
+    if (ys[diag - i - 1] < xs[i]) hi = i;
+    else lo = i + 1;
+  }
+  return {lo, diag - lo};
+}
+
+// Boundaries of 'parts' slices of about equal sizes. A value present in both
+// inputs must not be cut from its copy: when xs[i - 1] == ys[j], ys[j] moves
+// to the slice before.
+template<typename T>
+auto partition(T const* xs, size_t nx, T const* ys, size_t ny, size_t parts) -> std::vector<split> {
+  auto bounds = std::vector<split>(parts + 1);
+  for (auto p = size_t{1}; p < parts; ++p) {
+    auto s = merge_path(xs, nx, ys, ny, (nx + ny) * p / parts);
+    if (s.i > 0 && s.j < ny && !(xs[s.i - 1] < ys[s.j])) ++s.j;
+    bounds[p] = s;
+  }
+  bounds[parts] = {nx, ny};
+  return bounds;
+}
+
+// 'count' returns the size of the output of a slice and 'write' writes it
+// and returns the end of what it wrote. A single slice is written directly
+// into an output of 'bound' elements.
+template<typename T, typename Count, typename Write>
+auto run_slices(::par::pool& pool, std::vector<T> const& xs, std::vector<T> const& ys,
+                std::vector<T>& out, size_t bound, Count count, Write write) -> void {
+  auto const nx = xs.size(), ny = ys.size();
+  auto const parts = std::clamp<size_t>((nx + ny) / min_slice, 1, pool.size());
+  if (parts == 1) {
+    out.resize(bound);
+    out.resize(size_t(write(xs.data(), nx, ys.data(), ny, out.data()) - out.data()));
+    return;
+  }
+
+  auto const bounds = partition(xs.data(), nx, ys.data(), ny, parts);
+  auto slice = [&](size_t p, auto&& f) {
+    auto const b = bounds[p], e = bounds[p + 1];
+    return f(xs.data() + b.i, e.i - b.i, ys.data() + b.j, e.j - b.j);
+  };
+
+  auto offsets = std::vector<size_t>(parts + 1);
+  auto group = ::par::task_group{};
+  for (auto p = size_t{0}; p < parts; ++p)
+    pool.spawn(group, [&, p] { offsets[p + 1] = slice(p, count); });
+  pool.wait(group);
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  out.resize(offsets.back());
+  for (auto p = size_t{0}; p < parts; ++p)
+    pool.spawn(group, [&, p] {
+      slice(p, [&](T const* x, size_t n, T const* y, size_t m) {
+        return write(x, n, y, m, out.data() + offsets[p]);
+      });
+    });
+  pool.wait(group);
+}
+
+} /* end namespace par_detail */
+
+// Writes xs ∪ ys into 'out', replacing its contents.
+template<typename T>
+auto vectorset_union_parallel_into(::par::pool& pool, std::vector<T> const& xs,
+                                   std::vector<T> const& ys, std::vector<T>& out) -> void {
+  par_detail::run_slices(pool, xs, ys, out, xs.size() + ys.size(),
+    [](T const* x, size_t n, T const* y, size_t m) {
+      return n + m - simd::detail::intersection_size_scalar(x, n, y, m);
+    },
+    [](T const* x, size_t n, T const* y, size_t m, T* o) {
+      return o + simd::detail::union_scalar(x, n, y, m, o);
+    });
+}
+
+template<typename T>
+auto vectorset_union_parallel(::par::pool& pool, std::vector<T> const& xs,
+                              std::vector<T> const& ys) -> std::vector<T> {
+  auto u = std::vector<T>{};
+  vectorset_union_parallel_into(pool, xs, ys, u);
+  return u;
+}
+
+// Writes xs ∩ ys into 'out', replacing its contents.
+template<typename T>
+auto vectorset_intersection_parallel_into(::par::pool& pool, std::vector<T> const& xs,
+                                          std::vector<T> const& ys, std::vector<T>& out) -> void {
+  par_detail::run_slices(pool, xs, ys, out, std::min(xs.size(), ys.size()),
+    [](T const* x, size_t n, T const* y, size_t m) {
+      return simd::detail::intersection_size_scalar(x, n, y, m);
+    },
+    // Not intersect_scalar: it writes one element past its output, into the
+    // next slice.
+    [](T const* x, size_t n, T const* y, size_t m, T* o) {
+      return std::set_intersection(x, x + n, y, y + m, o);
+    });
+}
+
+template<typename T>
+auto vectorset_intersection_parallel(::par::pool& pool, std::vector<T> const& xs,
+                                     std::vector<T> const& ys) -> std::vector<T> {
+  auto inter = std::vector<T>{};
+  vectorset_intersection_parallel_into(pool, xs, ys, inter);
+  return inter;
+}
+
+} /* end namespace benchunion */
+
+#endif
@@ -0,0 +1,640 @@
+#ifndef BENCH_ROARING_HH_
+#define BENCH_ROARING_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// A compressed bitmap set of 32-bit integers (Chambi, Lemire et al.). The
+// values are split by their high 16 bits into chunks, each held in the
+// smallest of three containers:
+//  - a sorted array of the low 16 bits, up to 4096 values (2 bytes each),
+//  - a bitmap of 2^16 bits (8 kB, whatever the number of values),
+//  - a sorted list of runs of consecutive values (4 bytes per run).
+namespace benchunion {
+
+namespace roaring_detail {
+
+constexpr size_t max_array_size = 4096;
+constexpr size_t bitmap_words = (1 << 16) / 64;
+
+struct array_container {
+  std::vector<uint16_t> values;
+};
+
+struct bitmap_container {
+  std::vector<uint64_t> words = std::vector<uint64_t>(bitmap_words);
+  size_t cardinality = 0;
+
+  auto test(uint16_t v) const -> bool { return words[v / 64] >> (v % 64) & 1; }
+
+  auto set(uint16_t v) -> bool {
+    auto const before = words[v / 64];
+    words[v / 64] |= uint64_t{1} << (v % 64);
+    cardinality += before != words[v / 64];
+    return before != words[v / 64];
+  }
+
+  // Sets the bits of [first, last].
+  auto set_range(uint32_t first, uint32_t last) -> void {
+    for (auto w = first / 64; w <= last / 64; ++w) {
+      auto const lo = w == first / 64? first % 64 : 0;
+      auto const hi = w == last / 64? last % 64 : 63;
+      auto const mask = (~uint64_t{0} >> (63 - hi + lo)) << lo;
+      cardinality += __builtin_popcountll(mask & ~words[w]);
+      words[w] |= mask;
+    }
+  }
+};
+
+// The values start, ..., start + length.
+struct run {
+  uint16_t start;
+  uint16_t length;
+
+  auto last() const -> uint32_t { return uint32_t(start) + length; }
+};
+
+struct run_container {
+  std::vector<run> runs;
+};
+
+using container = std::variant<array_container, bitmap_container, run_container>;
+
+inline auto cardinality(container const& c) -> size_t {
+  return std::visit([](auto const& x) -> size_t {
+    using C = std::decay_t<decltype(x)>;
+    if constexpr (std::is_same_v<C, array_container>) return x.values.size();
+    else if constexpr (std::is_same_v<C, bitmap_container>) return x.cardinality;
+    else {
+      auto n = size_t{0};
+      for (auto const& r : x.runs) n += size_t(r.length) + 1;
+      return n;
+    }
+  }, c);
+}
+
+// Heap bytes held by the container.
+inline auto bytes(container const& c) -> size_t {
+  return std::visit([](auto const& x) -> size_t {
+    using C = std::decay_t<decltype(x)>;
+    if constexpr (std::is_same_v<C, array_container>) return x.values.capacity() * sizeof(uint16_t);
+    else if constexpr (std::is_same_v<C, bitmap_container>) return x.words.capacity() * sizeof(uint64_t);
+    else return x.runs.capacity() * sizeof(run);
+  }, c);
+}
+
+// First run that does not end before v.
+inline auto find_run(std::vector<run> const& runs, uint16_t v) -> std::vector<run>::const_iterator {
+  return std::lower_bound(runs.begin(), runs.end(), v,
+                          [](run const& r, uint16_t v) { return r.last() < v; });
+}
+
+inline auto contains(container const& c, uint16_t v) -> bool {
+  return std::visit([v](auto const& x) -> bool {
+    using C = std::decay_t<decltype(x)>;
+    if constexpr (std::is_same_v<C, array_container>) {
+      return std::binary_search(x.values.begin(), x.values.end(), v);
+    } else if constexpr (std::is_same_v<C, bitmap_container>) {
+      return x.test(v);
+    } else {
+      auto const it = find_run(x.runs, v);
+      return it != x.runs.end() && it->start <= v;
+    }
+  }, c);
+}
+
+template<typename F>
+auto for_each(container const& c, F&& f) -> void {
+  std::visit([&](auto const& x) {
+    using C = std::decay_t<decltype(x)>;
+    if constexpr (std::is_same_v<C, array_container>) {
+      for (auto v : x.values) f(v);
+    } else if constexpr (std::is_same_v<C, bitmap_container>) {
+      for (auto w = size_t{0}; w < bitmap_words; ++w)
+        for (auto bits = x.words[w]; bits; bits &= bits - 1)
+          f(uint16_t(w * 64 + __builtin_ctzll(bits)));
+    } else {
+      for (auto const& r : x.runs)
+        for (auto v = uint32_t(r.start); v <= r.last(); ++v) f(uint16_t(v));
+    }
+  }, c);
+}
+
+inline auto to_bitmap(container const& c) -> bitmap_container {
+  if (auto const* b = std::get_if<bitmap_container>(&c)) return *b;
+  auto b = bitmap_container{};
+  if (auto const* r = std::get_if<run_container>(&c)) {
+    for (auto const& x : r->runs) b.set_range(x.start, x.last());
+  } else {
+    for_each(c, [&](uint16_t v) { b.set(v); });
+  }
+  return b;
+}
+
+// A bitmap, or an array when that is smaller.
+inline auto shrink(bitmap_container&& b) -> container {
+  if (b.cardinality > max_array_size) return std::move(b);
+  auto a = array_container{};
+  a.values.reserve(b.cardinality);
+  for_each(container{std::move(b)}, [&](uint16_t v) { a.values.push_back(v); });
+  return a;
+}
+
+inline auto insert(container& c, uint16_t v) -> bool {
+  if (auto* a = std::get_if<array_container>(&c)) {
+    auto const it = std::lower_bound(a->values.begin(), a->values.end(), v);
+    if (it != a->values.end() && *it == v) return false;
+    if (a->values.size() < max_array_size) {
+      a->values.insert(it, v);
+      return true;
+    }
+    c = to_bitmap(c);
+  }
+  if (auto* b = std::get_if<bitmap_container>(&c)) return b->set(v);
+
+  auto& runs = std::get<run_container>(c).runs;
+  auto it = runs.begin() + (find_run(runs, v) - runs.cbegin());
+  if (it != runs.end() && it->start <= v) return false;
+  auto const joins_prev = it != runs.begin() && std::prev(it)->last() + 1 == v;
+  auto const joins_next = it != runs.end() && uint32_t(v) + 1 == it->start;
+  if (joins_prev && joins_next) {
+    std::prev(it)->length += it->length + 2;
+    runs.erase(it);
+  } else if (joins_prev) {
+    ++std::prev(it)->length;
+  } else if (joins_next) {
+    --it->start;
+    ++it->length;
+  } else {
+    runs.insert(it, run{v, 0});
+  }
+  return true;
+}
+
+inline auto intersect(container const& x, container const& y) -> container {
+  auto const* xa = std::get_if<array_container>(&x);
+  auto const* ya = std::get_if<array_container>(&y);
+  if (xa && ya) {
+    auto a = array_container{};
+    std::set_intersection(xa->values.begin(), xa->values.end(),
+                          ya->values.begin(), ya->values.end(), std::back_inserter(a.values));
+    return a;
+  }
+  auto const* xr = std::get_if<run_container>(&x);
+  auto const* yr = std::get_if<run_container>(&y);
+  if ((xa && yr) || (ya && xr)) {
+    // Both sorted: walk the runs along the array.
+    auto const& arr = xa? *xa : *ya;
+    auto const& runs = xa? yr->runs : xr->runs;
+    auto a = array_container{};
+    auto r = runs.begin();
+    for (auto v : arr.values) {
+      while (r != runs.end() && r->last() < v) ++r;
+      if (r == runs.end()) break;
+      if (r->start <= v) a.values.push_back(v);
+    }
+    return a;
+  }
+  if (xa || ya) {
+    // The array is at most 4096 values: test each of them in the bitmap.
+    auto const& arr = xa? *xa : *ya;
+    auto const& other = std::get<bitmap_container>(xa? y : x);
+    auto a = array_container{};
+    for (auto v : arr.values) if (other.test(v)) a.values.push_back(v);
+    return a;
+  }
+  if (xr && yr) {
+    auto r = run_container{};
+    auto i = xr->runs.begin(), j = yr->runs.begin();
+    while (i != xr->runs.end() && j != yr->runs.end()) {
+      auto const first = std::max(i->start, j->start);
+      auto const last = std::min(i->last(), j->last());
+      if (first <= last) r.runs.push_back(run{first, uint16_t(last - first)});
+      (i->last() < j->last()? i : j)++;
+    }
+    return r;
+  }
+  // Bitmap and run, or two bitmaps: copy the one that is not a bitmap yet.
+  auto const y_bitmap = std::holds_alternative<bitmap_container>(y);
+  auto b = to_bitmap(y_bitmap? x : y);
+  auto const& other = std::get<bitmap_container>(y_bitmap? y : x);
+  b.cardinality = 0;
+  for (auto w = size_t{0}; w < bitmap_words; ++w) {
+    b.words[w] &= other.words[w];
+    b.cardinality += __builtin_popcountll(b.words[w]);
+  }
+  return shrink(std::move(b));
+}
+
+inline auto unite(container const& x, container const& y) -> container {
+  auto const* xa = std::get_if<array_container>(&x);
+  auto const* ya = std::get_if<array_container>(&y);
+  if (xa && ya && xa->values.size() + ya->values.size() <= max_array_size) {
+    auto a = array_container{};
+    a.values.reserve(xa->values.size() + ya->values.size());
+    std::set_union(xa->values.begin(), xa->values.end(),
+                   ya->values.begin(), ya->values.end(), std::back_inserter(a.values));
+    return a;
+  }
+  auto const* xr = std::get_if<run_container>(&x);
+  auto const* yr = std::get_if<run_container>(&y);
+  if (xr && yr) {
+    auto r = run_container{};
+    auto const add = [&](run const& n) {
+      if (!r.runs.empty() && n.start <= r.runs.back().last() + 1) {
+        auto const last = std::max(r.runs.back().last(), n.last());
+        r.runs.back().length = uint16_t(last - r.runs.back().start);
+      } else {
+        r.runs.push_back(n);
+      }
+    };
+    auto i = xr->runs.begin(), j = yr->runs.begin();
+    while (i != xr->runs.end() || j != yr->runs.end()) {
+      if (j == yr->runs.end() || (i != xr->runs.end() && i->start < j->start)) add(*i++);
+      else add(*j++);
+    }
+    return r;
+  }
+  // Otherwise the result goes into a bitmap: the larger of the two inputs
+  // if it already is one.
+  auto const x_bitmap = std::holds_alternative<bitmap_container>(x);
+  auto b = to_bitmap(x_bitmap? x : y);
+  auto const& other = x_bitmap? y : x;
+  if (auto const* ob = std::get_if<bitmap_container>(&other)) {
+    b.cardinality = 0;
+    for (auto w = size_t{0}; w < bitmap_words; ++w) {
+      b.words[w] |= ob->words[w];
+      b.cardinality += __builtin_popcountll(b.words[w]);
+    }
+  } else if (auto const* orun = std::get_if<run_container>(&other)) {
+    for (auto const& r : orun->runs) b.set_range(r.start, r.last());
+  } else {
+    for_each(other, [&](uint16_t v) { b.set(v); });
+  }
+  return shrink(std::move(b));
+}
+
+// |x ∩ y|, without building it.
+inline auto intersection_size(container const& x, container const& y) -> size_t {
+  auto const* xb = std::get_if<bitmap_container>(&x);
+  auto const* yb = std::get_if<bitmap_container>(&y);
+  if (xb && yb) {
+    auto n = size_t{0};
+    for (auto w = size_t{0}; w < bitmap_words; ++w) n += __builtin_popcountll(xb->words[w] & yb->words[w]);
+    return n;
+  }
+  // Look up the values of the smaller one in the other.
+  auto const& small = cardinality(x) <= cardinality(y)? x : y;
+  auto const& large = &small == &x? y : x;
+  auto n = size_t{0};
+  for_each(small, [&](uint16_t v) { n += contains(large, v); });
+  return n;
+}
+
+// x ∪ y into x: a bitmap x is updated in place.
+inline auto unite_inplace(container& x, container const& y) -> void {
+  auto* b = std::get_if<bitmap_container>(&x);
+  if (!b) {
+    x = unite(x, y);
+    return;
+  }
+  if (auto const* yb = std::get_if<bitmap_container>(&y)) {
+    b->cardinality = 0;
+    for (auto w = size_t{0}; w < bitmap_words; ++w) {
+      b->words[w] |= yb->words[w];
+      b->cardinality += __builtin_popcountll(b->words[w]);
+    }
+  } else if (auto const* yr = std::get_if<run_container>(&y)) {
+    for (auto const& r : yr->runs) b->set_range(r.start, r.last());
+  } else {
+    for_each(y, [&](uint16_t v) { b->set(v); });
+  }
+}
+
+// x ∩ y into x: an array x is filtered in place.
+inline auto intersect_inplace(container& x, container const& y) -> void {
+  auto* a = std::get_if<array_container>(&x);
+  if (!a) {
+    x = intersect(x, y);
+    return;
+  }
+  a->values.erase(std::remove_if(a->values.begin(), a->values.end(),
+                                 [&](uint16_t v) { return !contains(y, v); }),
+                  a->values.end());
+}
+
+// Converts the container to runs when they take less room.
+inline auto run_optimize(container& c) -> void {
+  if (std::holds_alternative<run_container>(c)) return;
+  auto r = run_container{};
+  for_each(c, [&](uint16_t v) {
+    if (!r.runs.empty() && r.runs.back().last() + 1 == v) ++r.runs.back().length;
+    else r.runs.push_back(run{v, 0});
+  });
+  auto const as_is = std::holds_alternative<array_container>(c)
+    ? cardinality(c) * sizeof(uint16_t) : bitmap_words * sizeof(uint64_t);
+  if (r.runs.size() * sizeof(run) < as_is) {
+    r.runs.shrink_to_fit();
+    c = std::move(r);
+  }
+}
+
+} /* end namespace roaring_detail */
+
+class roaring_set {
+ public:
+  using value_type = uint32_t;
+
+  roaring_set() = default;
+
+  template<typename It>
+  roaring_set(It first, It last) {
+    for (; first != last; ++first) insert(uint32_t(*first));
+  }
+
+  auto insert(uint32_t x) -> bool {
+    auto const key = uint16_t(x >> 16);
+    auto const it = std::lower_bound(m_keys.begin(), m_keys.end(), key);
+    auto const i = size_t(it - m_keys.begin());
+    if (it == m_keys.end() || *it != key) {
+      m_keys.insert(it, key);
+      m_containers.emplace(m_containers.begin() + i);
+    }
+    return roaring_detail::insert(m_containers[i], uint16_t(x));
+  }
+
+  auto contains(uint32_t x) const -> bool {
+    auto const key = uint16_t(x >> 16);
+    auto const it = std::lower_bound(m_keys.begin(), m_keys.end(), key);
+    return it != m_keys.end() && *it == key
+      && roaring_detail::contains(m_containers[it - m_keys.begin()], uint16_t(x));
+  }
+
+  auto size() const -> size_t {
+    auto n = size_t{0};
+    for (auto const& c : m_containers) n += roaring_detail::cardinality(c);
+    return n;
+  }
+
+  auto empty() const -> bool { return m_keys.empty(); }
+
+  // Bytes held by the set, including the object itself.
+  auto bytes() const -> size_t {
+    auto n = sizeof(*this) + m_keys.capacity() * sizeof(uint16_t)
+      + m_containers.capacity() * sizeof(roaring_detail::container);
+    for (auto const& c : m_containers) n += roaring_detail::bytes(c);
+    return n;
+  }
+
+  // Calls f on every value, in increasing order.
+  template<typename F>
+  auto for_each(F&& f) const -> void {
+    for (auto i = size_t{0}; i < m_keys.size(); ++i) {
+      auto const high = uint32_t(m_keys[i]) << 16;
+      roaring_detail::for_each(m_containers[i], [&](uint16_t low) { f(high | low); });
+    }
+  }
+
+  // Converts every container that would be smaller as runs.
+  auto run_optimize() -> void {
+    for (auto& c : m_containers) roaring_detail::run_optimize(c);
+  }
+
+  friend auto operator&(roaring_set const& xs, roaring_set const& ys) -> roaring_set {
+    auto inter = roaring_set{};
+    auto i = size_t{0}, j = size_t{0};
+    while (i < xs.m_keys.size() && j < ys.m_keys.size()) {
+      if (xs.m_keys[i] < ys.m_keys[j]) {
+        ++i;
+      } else if (ys.m_keys[j] < xs.m_keys[i]) {
+        ++j;
+      } else {
+        auto c = roaring_detail::intersect(xs.m_containers[i], ys.m_containers[j]);
+        if (roaring_detail::cardinality(c) > 0) {
+          inter.m_keys.push_back(xs.m_keys[i]);
+          inter.m_containers.push_back(std::move(c));
+        }
+        ++i, ++j;
+      }
+    }
+    return inter;
+  }
+
+  // Writes the values of the intersection with ys to 'out', in increasing
+  // order, without building it.
+  template<typename Out>
+  auto intersection_into(roaring_set const& ys, Out out) const -> Out {
+    for_each_shared(ys, [&](uint32_t high, roaring_detail::container const& x, roaring_detail::container const& y) {
+      auto const* xb = std::get_if<roaring_detail::bitmap_container>(&x);
+      auto const* yb = std::get_if<roaring_detail::bitmap_container>(&y);
+      if (xb && yb) {
+        for (auto w = size_t{0}; w < roaring_detail::bitmap_words; ++w)
+          for (auto bits = xb->words[w] & yb->words[w]; bits; bits &= bits - 1)
+            *out++ = high | uint32_t(w * 64 + __builtin_ctzll(bits));
+        return;
+      }
+      auto const& small = roaring_detail::cardinality(x) <= roaring_detail::cardinality(y)? x : y;
+      auto const& large = &small == &x? y : x;
+      roaring_detail::for_each(small, [&](uint16_t v) {
+        if (roaring_detail::contains(large, v)) *out++ = high | v;
+      });
+    });
+    return out;
+  }
+
+  auto intersection_size(roaring_set const& ys) const -> size_t {
+    auto n = size_t{0};
+    for_each_shared(ys, [&](uint32_t, roaring_detail::container const& x, roaring_detail::container const& y) {
+      n += roaring_detail::intersection_size(x, y);
+    });
+    return n;
+  }
+
+  // Keeps the chunks found in ys, intersected in place where they can be.
+  auto operator&=(roaring_set const& ys) -> roaring_set& {
+    auto kept = size_t{0};
+    auto j = size_t{0};
+    for (auto i = size_t{0}; i < m_keys.size(); ++i) {
+      while (j < ys.m_keys.size() && ys.m_keys[j] < m_keys[i]) ++j;
+      if (j == ys.m_keys.size()) break;
+      if (ys.m_keys[j] != m_keys[i]) continue;
+      roaring_detail::intersect_inplace(m_containers[i], ys.m_containers[j]);
+      if (roaring_detail::cardinality(m_containers[i]) == 0) continue;
+      m_keys[kept] = m_keys[i];
+      if (kept != i) m_containers[kept] = std::move(m_containers[i]);
+      ++kept;
+    }
+    m_keys.resize(kept);
+    m_containers.erase(m_containers.begin() + kept, m_containers.end());
+    return *this;
+  }
+
+  // Writes the values of the union with ys to 'out', in increasing order,
+  // without building it. The chunks in both go through a bitmap kept for
+  // the whole call, unless both are small arrays.
+  template<typename Out>
+  auto union_into(roaring_set const& ys, Out out) const -> Out {
+    auto scratch = roaring_detail::bitmap_container{};
+    auto const emit = [&](uint32_t high, roaring_detail::container const& c) {
+      roaring_detail::for_each(c, [&](uint16_t v) { *out++ = high | v; });
+    };
+    auto i = size_t{0}, j = size_t{0};
+    while (i < m_keys.size() || j < ys.m_keys.size()) {
+      if (j == ys.m_keys.size() || (i < m_keys.size() && m_keys[i] < ys.m_keys[j])) {
+        emit(uint32_t(m_keys[i]) << 16, m_containers[i]);
+        ++i;
+      } else if (i == m_keys.size() || ys.m_keys[j] < m_keys[i]) {
+        emit(uint32_t(ys.m_keys[j]) << 16, ys.m_containers[j]);
+        ++j;
+      } else {
+        auto const high = uint32_t(m_keys[i]) << 16;
+        auto const* xa = std::get_if<roaring_detail::array_container>(&m_containers[i]);
+        auto const* ya = std::get_if<roaring_detail::array_container>(&ys.m_containers[j]);
+        if (xa && ya) {
+          auto x = xa->values.begin(), y = ya->values.begin();
+          auto const x_end = xa->values.end(), y_end = ya->values.end();
+          while (x != x_end && y != y_end) {
+            auto const v = std::min(*x, *y);
+            x += *x == v;
+            y += *y == v;
+            *out++ = high | v;
+          }
+          while (x != x_end) *out++ = high | *x++;
+          while (y != y_end) *out++ = high | *y++;
+        } else {
+          std::fill(scratch.words.begin(), scratch.words.end(), 0);
+          scratch.cardinality = 0;
+          auto c = roaring_detail::container{std::move(scratch)};
+          roaring_detail::unite_inplace(c, m_containers[i]);
+          roaring_detail::unite_inplace(c, ys.m_containers[j]);
+          emit(high, c);
+          scratch = std::move(std::get<roaring_detail::bitmap_container>(c));
+        }
+        ++i, ++j;
+      }
+    }
+    return out;
+  }
+
+  auto union_size(roaring_set const& ys) const -> size_t {
+    auto n = ys.size() + size();
+    for_each_shared(ys, [&](uint32_t, roaring_detail::container const& x, roaring_detail::container const& y) {
+      n -= roaring_detail::intersection_size(x, y);
+    });
+    return n;
+  }
+
+  // Adds the chunks of ys: the containers of xs are moved, not copied, and
+  // united in place where they can be.
+  auto operator|=(roaring_set const& ys) -> roaring_set& {
+    auto keys = std::vector<uint16_t>{};
+    auto containers = std::vector<roaring_detail::container>{};
+    keys.reserve(m_keys.size() + ys.m_keys.size());
+    containers.reserve(m_keys.size() + ys.m_keys.size());
+    auto i = size_t{0}, j = size_t{0};
+    while (i < m_keys.size() || j < ys.m_keys.size()) {
+      if (j == ys.m_keys.size() || (i < m_keys.size() && m_keys[i] < ys.m_keys[j])) {
+        keys.push_back(m_keys[i]);
+        containers.push_back(std::move(m_containers[i++]));
+      } else if (i == m_keys.size() || ys.m_keys[j] < m_keys[i]) {
+        keys.push_back(ys.m_keys[j]);
+        containers.push_back(ys.m_containers[j++]);
+      } else {
+        roaring_detail::unite_inplace(m_containers[i], ys.m_containers[j++]);
+        keys.push_back(m_keys[i]);
+        containers.push_back(std::move(m_containers[i++]));
+      }
+    }
+    m_keys = std::move(keys);
+    m_containers = std::move(containers);
+    return *this;
+  }
+
+  friend auto operator|(roaring_set const& xs, roaring_set const& ys) -> roaring_set {
+    auto u = roaring_set{};
+    u.m_keys.reserve(xs.m_keys.size() + ys.m_keys.size());
+    u.m_containers.reserve(xs.m_keys.size() + ys.m_keys.size());
+    auto i = size_t{0}, j = size_t{0};
+    while (i < xs.m_keys.size() || j < ys.m_keys.size()) {
+      if (j == ys.m_keys.size() || (i < xs.m_keys.size() && xs.m_keys[i] < ys.m_keys[j])) {
+        u.m_keys.push_back(xs.m_keys[i]);
+        u.m_containers.push_back(xs.m_containers[i++]);
+      } else if (i == xs.m_keys.size() || ys.m_keys[j] < xs.m_keys[i]) {
+        u.m_keys.push_back(ys.m_keys[j]);
+        u.m_containers.push_back(ys.m_containers[j++]);
+      } else {
+        u.m_keys.push_back(xs.m_keys[i]);
+        u.m_containers.push_back(roaring_detail::unite(xs.m_containers[i++], ys.m_containers[j++]));
+      }
+    }
+    return u;
+  }
+
+ private:
+  // Calls f with the high bits and the containers of each chunk in both sets.
+  template<typename F>
+  auto for_each_shared(roaring_set const& ys, F&& f) const -> void {
+    auto i = size_t{0}, j = size_t{0};
+    while (i < m_keys.size() && j < ys.m_keys.size()) {
+      if (m_keys[i] < ys.m_keys[j]) {
+        ++i;
+      } else if (ys.m_keys[j] < m_keys[i]) {
+        ++j;
+      } else {
+        f(uint32_t(m_keys[i]) << 16, m_containers[i], ys.m_containers[j]);
+        ++i, ++j;
+      }
+    }
+  }
+
+  std::vector<uint16_t> m_keys;
+  std::vector<roaring_detail::container> m_containers;
+};
+
+inline auto roaringset_union(roaring_set const& xs, roaring_set const& ys) -> roaring_set {
+  return xs | ys;
+}
+
+inline auto roaringset_intersection(roaring_set const& xs, roaring_set const& ys) -> roaring_set {
+  return xs & ys;
+}
+
+// The forms below skip the result set, as those of union.hh and
+// intersection.hh: the '_into' ones write the values to 'out', in
+// increasing order, the '_size' ones only count them and the '_inplace'
+// ones update xs.
+template<typename Out>
+auto roaringset_union_into(roaring_set const& xs, roaring_set const& ys, Out out) -> Out {
+  return xs.union_into(ys, out);
+}
+
+inline auto roaringset_union_size(roaring_set const& xs, roaring_set const& ys) -> size_t {
+  return xs.union_size(ys);
+}
+
+inline auto roaringset_union_inplace(roaring_set& xs, roaring_set const& ys) -> void {
+  xs |= ys;
+}
+
+template<typename Out>
+auto roaringset_intersection_into(roaring_set const& xs, roaring_set const& ys, Out out) -> Out {
+  return xs.intersection_into(ys, out);
+}
+
+inline auto roaringset_intersection_size(roaring_set const& xs, roaring_set const& ys) -> size_t {
+  return xs.intersection_size(ys);
+}
+
+inline auto roaringset_intersection_inplace(roaring_set& xs, roaring_set const& ys) -> void {
+  xs &= ys;
+}
+
+} /* end namespace benchunion */
+
+#endif
@@ -0,0 +1,259 @@
+#ifndef BENCH_SIMD_INTERSECTION_HH_
+#define BENCH_SIMD_INTERSECTION_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <boost/container/flat_set.hpp>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BENCHSET_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// Intersection of sorted sets of 32-bit integers, block by block: a block of
+// xs is compared with every rotation of a block of ys, and the matching
+// elements of xs are packed and stored directly into the output (Schlegel et
+// al., Lemire et al.). The kernel is chosen at runtime from what the CPU
+// supports.
+namespace benchunion::simd {
+
+enum class isa { scalar, sse42, avx2, avx512 };
+
+inline auto name(isa i) -> char const* {
+  switch (i) {
+    case isa::scalar: return "scalar";
+    case isa::sse42: return "sse4.2";
+    case isa::avx2: return "avx2";
+    case isa::avx512: return "avx512";
+  }
+  return "";
+}
+
+inline auto supported(isa i) -> bool {
+#ifdef BENCHSET_SIMD_X86
+  switch (i) {
+    case isa::scalar: return true;
+    case isa::sse42: return __builtin_cpu_supports("sse4.2");
+    case isa::avx2: return __builtin_cpu_supports("avx2");
+    case isa::avx512: return __builtin_cpu_supports("avx512f");
+  }
+  return false;
+#else
+  return i == isa::scalar;
+#endif
+}
+
+// The kernel to use by default, detected once. AVX2 comes first: the
+// AVX-512 compares all go through mask registers, which only one port
+// writes, and the wider kernel measured slower wherever both are available.
+inline auto best_isa() -> isa {
+  static auto const best = [] {
+    for (auto i : {isa::avx2, isa::avx512, isa::sse42})
+      if (supported(i)) return i;
+    return isa::scalar;
+  }();
+  return best;
+}
+
+// The vector kernels store whole registers: the output must have room for
+// min(nx, ny) + slack elements.
+constexpr size_t slack = 16;
+
+namespace detail {
+
+template<typename T>
+constexpr bool is_word = std::is_integral_v<T> && sizeof(T) == 4;
+
+// Branchless merge, also used for the tails the vector kernels leave.
+template<typename T>
+auto intersect_scalar(T const* xs, size_t nx, T const* ys, size_t ny, T* out) -> size_t {
+  auto i = size_t{0}, j = size_t{0}, k = size_t{0};
+  while (i < nx && j < ny) {
+    auto const x = xs[i], y = ys[j];
+    out[k] = x;
+    k += x == y;
+    i += x <= y;
+    j += y <= x;
+  }
+  return k;
+}
+
+#ifdef BENCHSET_SIMD_X86
+
+// pshufb masks moving the 32-bit lanes selected by a 4-bit mask to the front.
+struct sse_pack_table {
+  alignas(16) uint8_t bytes[16][16];
+
+  constexpr sse_pack_table() : bytes{} {
+    for (auto m = 0; m < 16; ++m) {
+      auto k = 0;
+      for (auto lane = 0; lane < 4; ++lane) {
+        if (m & (1 << lane)) {
+          for (auto b = 0; b < 4; ++b) bytes[m][4 * k + b] = uint8_t(4 * lane + b);
+          ++k;
+        }
+      }
+      for (auto b = 4 * k; b < 16; ++b) bytes[m][b] = 0x80;
+    }
+  }
+};
+
+// vpermd indices moving the lanes selected by an 8-bit mask to the front.
+struct avx2_pack_table {
+  alignas(32) uint32_t lanes[256][8];
+
+  constexpr avx2_pack_table() : lanes{} {
+    for (auto m = 0; m < 256; ++m) {
+      auto k = 0;
+      for (auto lane = 0; lane < 8; ++lane)
+        if (m & (1 << lane)) lanes[m][k++] = lane;
+    }
+  }
+};
+
+inline constexpr auto sse_pack = sse_pack_table{};
+inline constexpr auto avx2_pack = avx2_pack_table{};
+
+// Common driver: 'block' compares xs[i, i+W) with ys[j, j+W), stores the
+// matches at out + k and returns their number. The block with the smaller
+// maximum is done with; the rest is left to the scalar merge.
+template<size_t W, typename T, typename Block>
+__attribute__((always_inline))
+inline auto intersect_blocks(T const* xs, size_t nx, T const* ys, size_t ny, T* out,
+                             Block&& block) -> size_t {
+  auto i = size_t{0}, j = size_t{0}, k = size_t{0};
+  while (i + W <= nx && j + W <= ny) {
+    k += block(xs + i, ys + j, out + k);
+    auto const xmax = xs[i + W - 1], ymax = ys[j + W - 1];
+    i += xmax <= ymax? W : 0;
+    j += ymax <= xmax? W : 0;
+  }
+  return k + intersect_scalar(xs + i, nx - i, ys + j, ny - j, out + k);
+}
+
+template<typename T>
+__attribute__((target("sse4.2")))
+auto intersect_sse42(T const* xs, size_t nx, T const* ys, size_t ny, T* out) -> size_t {
+  return intersect_blocks<4>(xs, nx, ys, ny, out,
+    [](T const* x, T const* y, T* o) __attribute__((target("sse4.2"))) {
+      auto const vx = _mm_loadu_si128(reinterpret_cast<__m128i const*>(x));
+      auto vy = _mm_loadu_si128(reinterpret_cast<__m128i const*>(y));
+      auto eq = _mm_cmpeq_epi32(vx, vy);
+      for (auto r = 1; r < 4; ++r) {
+        vy = _mm_shuffle_epi32(vy, _MM_SHUFFLE(0, 3, 2, 1));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(vx, vy));
+      }
+      auto const m = _mm_movemask_ps(_mm_castsi128_ps(eq));
+      auto const shuf = _mm_load_si128(reinterpret_cast<__m128i const*>(sse_pack.bytes[m]));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(o), _mm_shuffle_epi8(vx, shuf));
+      return size_t(__builtin_popcount(m));
+    });
+}
+
+template<typename T>
+__attribute__((target("avx2")))
+auto intersect_avx2(T const* xs, size_t nx, T const* ys, size_t ny, T* out) -> size_t {
+  return intersect_blocks<8>(xs, nx, ys, ny, out,
+    [](T const* x, T const* y, T* o) __attribute__((target("avx2"))) {
+      auto const rot = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+      auto const vx = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(x));
+      auto vy = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(y));
+      auto eq = _mm256_cmpeq_epi32(vx, vy);
+      for (auto r = 1; r < 8; ++r) {
+        vy = _mm256_permutevar8x32_epi32(vy, rot);
+        eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(vx, vy));
+      }
+      auto const m = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+      auto const perm = _mm256_load_si256(reinterpret_cast<__m256i const*>(avx2_pack.lanes[m]));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(o), _mm256_permutevar8x32_epi32(vx, perm));
+      return size_t(__builtin_popcount(m));
+    });
+}
+
+// The rotations of vy are independent of each other, and the matches are
+// packed in a register: vpcompressd with a memory operand is much slower.
+// GCC 12 warns about an undefined register inside _mm512_alignr_epi32's own
+// header: a false positive.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+template<int... R>
+__attribute__((target("avx512f"), always_inline))
+inline auto match_rotations(__m512i vx, __m512i vy, std::integer_sequence<int, R...>) -> __mmask16 {
+  return (_mm512_cmpeq_epi32_mask(vx, vy) | ... |
+          _mm512_cmpeq_epi32_mask(vx, _mm512_alignr_epi32(vy, vy, R + 1)));
+}
+
+template<typename T>
+__attribute__((target("avx512f")))
+auto intersect_avx512(T const* xs, size_t nx, T const* ys, size_t ny, T* out) -> size_t {
+  return intersect_blocks<16>(xs, nx, ys, ny, out,
+    [](T const* x, T const* y, T* o) __attribute__((target("avx512f"))) {
+      auto const vx = _mm512_loadu_si512(x);
+      auto const vy = _mm512_loadu_si512(y);
+      auto const m = match_rotations(vx, vy, std::make_integer_sequence<int, 15>{});
+      _mm512_storeu_si512(o, _mm512_maskz_compress_epi32(m, vx));
+      return size_t(__builtin_popcount(m));
+    });
+}
+
+#pragma GCC diagnostic pop
+
+#endif
+
+} /* end namespace detail */
+
+// Writes xs ∩ ys into 'out' with the given kernel, which must be supported,
+// and returns the number of elements written.
+template<typename T>
+auto intersect(isa i, T const* xs, size_t nx, T const* ys, size_t ny, T* out) -> size_t {
+  static_assert(detail::is_word<T>, "the kernels work on 32-bit integers");
+  switch (i) {
+#ifdef BENCHSET_SIMD_X86
+    case isa::sse42: return detail::intersect_sse42(xs, nx, ys, ny, out);
+    case isa::avx2: return detail::intersect_avx2(xs, nx, ys, ny, out);
+    case isa::avx512: return detail::intersect_avx512(xs, nx, ys, ny, out);
+#endif
+    default: return detail::intersect_scalar(xs, nx, ys, ny, out);
+  }
+}
+
+template<typename T>
+auto intersect(T const* xs, size_t nx, T const* ys, size_t ny, T* out) -> size_t {
+  return intersect(best_isa(), xs, nx, ys, ny, out);
+}
+
+} /* end namespace benchunion::simd */
+
+namespace benchunion {
+
+template<typename T, typename A>
+auto vectorset_intersection_simd(std::vector<T, A> const& xs, std::vector<T, A> const& ys,
+                                 simd::isa i = simd::best_isa()) -> std::vector<T, A> {
+  auto inter = std::vector<T, A>(std::min(xs.size(), ys.size()) + simd::slack, xs.get_allocator());
+  inter.resize(simd::intersect(i, xs.data(), xs.size(), ys.data(), ys.size(), inter.data()));
+  return inter;
+}
+
+template<typename T, typename A>
+auto flatset_intersection_simd(boost::container::flat_set<T, std::less<T>, A> const& xs,
+                               boost::container::flat_set<T, std::less<T>, A> const& ys,
+                               simd::isa i = simd::best_isa())
+                               -> boost::container::flat_set<T, std::less<T>, A> {
+  auto seq = typename boost::container::flat_set<T, std::less<T>, A>::sequence_type(
+    std::min(xs.size(), ys.size()) + simd::slack, xs.get_allocator());
+  // A flat_set is contiguous but has no data().
+  auto const data = [](auto const& s) { return s.empty()? nullptr : &*s.begin(); };
+  seq.resize(simd::intersect(i, data(xs), xs.size(), data(ys), ys.size(), seq.data()));
+  auto inter = boost::container::flat_set<T, std::less<T>, A>(xs.get_allocator());
+  inter.adopt_sequence(boost::container::ordered_unique_range, std::move(seq));
+  return inter;
+}
+
+} /* end namespace benchunion */
+
+#endif
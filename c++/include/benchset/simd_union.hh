@@ -0,0 +1,279 @@
+#ifndef BENCH_SIMD_UNION_HH_
+#define BENCH_SIMD_UNION_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "benchset/simd_intersection.hh"
+
+// Union of sorted sets of 32-bit integers, written straight into an output
+// sized for the worst case. The vector kernels merge a block of W elements
+// with the W largest elements seen so far in a merge network (Inoue et al.),
+// store the W smallest and drop the values equal to their predecessor.
+namespace benchunion::simd {
+
+namespace detail {
+
+// Branch-free merge: the smaller head is written and every input whose head
+// it was advances, so values present in both inputs are written once.
+template<typename T>
+auto union_scalar(T const* xs, size_t nx, T const* ys, size_t ny, T* out) -> size_t {
+  auto i = size_t{0}, j = size_t{0}, k = size_t{0};
+  while (i < nx && j < ny) {
+    auto const x = xs[i], y = ys[j];
+    out[k++] = y < x? y : x;
+    i += x <= y;
+    j += y <= x;
+  }
+  out = std::copy(xs + i, xs + nx, out + k);
+  return k + (nx - i) + std::copy(ys + j, ys + ny, out) - out;
+}
+
+// Number of common elements, with the same merge.
+template<typename T>
+auto intersection_size_scalar(T const* xs, size_t nx, T const* ys, size_t ny) -> size_t {
+  auto i = size_t{0}, j = size_t{0}, k = size_t{0};
+  while (i < nx && j < ny) {
+    auto const x = xs[i], y = ys[j];
+    k += x == y;
+    i += x <= y;
+    j += y <= x;
+  }
+  return k;
+}
+
+#ifdef BENCHSET_SIMD_X86
+
+// The generic driver below passes __m256i around without being compiled for
+// AVX itself; it is always flattened into the AVX2 kernel, so the ABI of
+// those calls never matters.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+template<typename T>
+struct sse_union_ops {
+  using vec = __m128i;
+  static constexpr size_t width = 4;
+
+  __attribute__((target("sse4.2")))
+  static auto load(T const* p) -> vec { return _mm_loadu_si128(reinterpret_cast<vec const*>(p)); }
+
+  __attribute__((target("sse4.2")))
+  static auto store(T* p, vec v) -> void { _mm_storeu_si128(reinterpret_cast<vec*>(p), v); }
+
+  __attribute__((target("sse4.2")))
+  static auto min(vec a, vec b) -> vec {
+    if constexpr (std::is_signed_v<T>) return _mm_min_epi32(a, b);
+    else return _mm_min_epu32(a, b);
+  }
+
+  __attribute__((target("sse4.2")))
+  static auto max(vec a, vec b) -> vec {
+    if constexpr (std::is_signed_v<T>) return _mm_max_epi32(a, b);
+    else return _mm_max_epu32(a, b);
+  }
+
+  __attribute__((target("sse4.2")))
+  static auto rotate(vec v) -> vec { return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 3, 2, 1)); }
+
+  // [prev[3], v[0], v[1], v[2]]
+  __attribute__((target("sse4.2")))
+  static auto shift_in(vec prev, vec v) -> vec { return _mm_alignr_epi8(v, prev, 12); }
+
+  // Stores the lanes of v that differ from their predecessor, packed.
+  __attribute__((target("sse4.2")))
+  static auto store_unique(T* p, vec prev, vec v) -> size_t {
+    auto const dup = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, shift_in(prev, v))));
+    auto const m = ~dup & 0xf;
+    auto const shuf = _mm_load_si128(reinterpret_cast<vec const*>(sse_pack.bytes[m]));
+    store(p, _mm_shuffle_epi8(v, shuf));
+    return size_t(__builtin_popcount(m));
+  }
+};
+
+template<typename T>
+struct avx2_union_ops {
+  using vec = __m256i;
+  static constexpr size_t width = 8;
+
+  __attribute__((target("avx2")))
+  static auto load(T const* p) -> vec { return _mm256_loadu_si256(reinterpret_cast<vec const*>(p)); }
+
+  __attribute__((target("avx2")))
+  static auto store(T* p, vec v) -> void { _mm256_storeu_si256(reinterpret_cast<vec*>(p), v); }
+
+  __attribute__((target("avx2")))
+  static auto min(vec a, vec b) -> vec {
+    if constexpr (std::is_signed_v<T>) return _mm256_min_epi32(a, b);
+    else return _mm256_min_epu32(a, b);
+  }
+
+  __attribute__((target("avx2")))
+  static auto max(vec a, vec b) -> vec {
+    if constexpr (std::is_signed_v<T>) return _mm256_max_epi32(a, b);
+    else return _mm256_max_epu32(a, b);
+  }
+
+  __attribute__((target("avx2")))
+  static auto rotate(vec v) -> vec {
+    return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0));
+  }
+
+  // [prev[7], v[0], ..., v[6]]
+  __attribute__((target("avx2")))
+  static auto shift_in(vec prev, vec v) -> vec {
+    auto const r = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6));
+    auto const p = _mm256_permutevar8x32_epi32(prev, _mm256_set1_epi32(7));
+    return _mm256_blend_epi32(r, p, 1);
+  }
+
+  __attribute__((target("avx2")))
+  static auto store_unique(T* p, vec prev, vec v) -> size_t {
+    auto const dup = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, shift_in(prev, v))));
+    auto const m = ~dup & 0xff;
+    auto const perm = _mm256_load_si256(reinterpret_cast<vec const*>(avx2_pack.lanes[m]));
+    store(p, _mm256_permutevar8x32_epi32(v, perm));
+    return size_t(__builtin_popcount(m));
+  }
+};
+
+// Merges the sorted vectors a and b: a receives the W smallest values and b
+// the W largest, both sorted. Each round compares every lane with one lane of
+// the other vector, then rotates the minima by one lane.
+template<typename Ops, typename V>
+inline auto merge_network(V& a, V& b) -> void {
+  auto lo = Ops::min(a, b), hi = Ops::max(a, b);
+  for (auto r = size_t{1}; r < Ops::width; ++r) {
+    lo = Ops::rotate(lo);
+    auto const l = Ops::min(lo, hi);
+    hi = Ops::max(lo, hi);
+    lo = l;
+  }
+  a = Ops::rotate(lo);
+  b = hi;
+}
+
+template<typename Ops, typename T>
+inline auto union_blocks(T const* xs, size_t nx, T const* ys, size_t ny, T* out) -> size_t {
+  constexpr auto W = Ops::width;
+  if (nx < W || ny < W)
+    return union_scalar(xs, nx, ys, ny, out);
+
+  auto lo = Ops::load(xs), hi = Ops::load(ys);
+  auto i = W, j = W, k = size_t{0};
+  merge_network<Ops>(lo, hi);
+  // The first value has no predecessor: compare it with a different value.
+  alignas(64) T first[W] = {};
+  first[W - 1] = T(~std::min(xs[0], ys[0]));
+  auto prev = Ops::load(first);
+  k += Ops::store_unique(out + k, prev, lo);
+  prev = lo;
+
+  // Every value left in xs and ys is at least the smaller of their heads, so
+  // the W smallest of hi and the block with the smaller head are final.
+  while (i + W <= nx && j + W <= ny) {
+    auto next = Ops::load(xs[i] <= ys[j]? xs + i : ys + j);
+    (xs[i] <= ys[j]? i : j) += W;
+    merge_network<Ops>(next, hi);
+    k += Ops::store_unique(out + k, prev, next);
+    prev = next;
+  }
+
+  // hi holds W pending values, which may repeat each other: merge them with
+  // the shorter tail, then with the longer one, dropping whatever repeats the
+  // last value stored.
+  alignas(64) T pending[W];
+  Ops::store(pending, hi);
+  alignas(64) T last[W];
+  Ops::store(last, prev);
+  auto const lastv = last[W - 1];
+
+  T const* tails[2][2] = {{xs + i, xs + nx}, {ys + j, ys + ny}};
+  auto const s = (nx - i) <= (ny - j)? 0 : 1;
+  auto const* sf = tails[s][0]; auto const* sl = tails[s][1];
+  auto const* lf = tails[1 - s][0]; auto const* ll = tails[1 - s][1];
+  auto* pf = pending + 0;
+  if (*pf == lastv) ++pf;
+  if (sf != sl && *sf == lastv) ++sf;
+  if (lf != ll && *lf == lastv) ++lf;
+
+  T merged[2 * W];
+  auto const pl = std::unique(pf, pending + W);
+  auto const nm = union_scalar(pf, size_t(pl - pf), sf, size_t(sl - sf), merged);
+  return k + union_scalar(merged, nm, lf, size_t(ll - lf), out + k);
+}
+
+// flatten inlines the generic driver and the operations into the kernels,
+// which are the only functions compiled for the vector instruction sets.
+template<typename T>
+__attribute__((target("sse4.2"), flatten))
+auto union_sse42(T const* xs, size_t nx, T const* ys, size_t ny, T* out) -> size_t {
+  return union_blocks<sse_union_ops<T>>(xs, nx, ys, ny, out);
+}
+
+template<typename T>
+__attribute__((target("avx2"), flatten))
+auto union_avx2(T const* xs, size_t nx, T const* ys, size_t ny, T* out) -> size_t {
+  return union_blocks<avx2_union_ops<T>>(xs, nx, ys, ny, out);
+}
+
+#pragma GCC diagnostic pop
+
+#endif
+
+} /* end namespace detail */
+
+// Writes xs ∪ ys into 'out', which needs room for nx + ny + slack elements,
+// and returns the number of elements written. There is no AVX-512 kernel:
+// it falls back to AVX2.
+template<typename T>
+auto unite(isa i, T const* xs, size_t nx, T const* ys, size_t ny, T* out) -> size_t {
+  static_assert(detail::is_word<T>, "the kernels work on 32-bit integers");
+  switch (i) {
+#ifdef BENCHSET_SIMD_X86
+    case isa::sse42: return detail::union_sse42(xs, nx, ys, ny, out);
+    case isa::avx2:
+    case isa::avx512: return detail::union_avx2(xs, nx, ys, ny, out);
+#endif
+    default: return detail::union_scalar(xs, nx, ys, ny, out);
+  }
+}
+
+template<typename T>
+auto unite(T const* xs, size_t nx, T const* ys, size_t ny, T* out) -> size_t {
+  return unite(best_isa(), xs, nx, ys, ny, out);
+}
+
+} /* end namespace benchunion::simd */
+
+namespace benchunion {
+
+// Branch-free merge into an output allocated once for the worst case.
+template<typename T, typename A>
+auto vectorset_union_branchless(std::vector<T, A> const& xs,
+                                std::vector<T, A> const& ys) -> std::vector<T, A> {
+  auto u = std::vector<T, A>(xs.size() + ys.size(), xs.get_allocator());
+  u.resize(simd::detail::union_scalar(xs.data(), xs.size(), ys.data(), ys.size(), u.data()));
+  return u;
+}
+
+template<typename T, typename A>
+auto vectorset_union_simd(std::vector<T, A> const& xs, std::vector<T, A> const& ys,
+                          simd::isa i = simd::best_isa()) -> std::vector<T, A> {
+  auto u = std::vector<T, A>(xs.size() + ys.size() + simd::slack, xs.get_allocator());
+  u.resize(simd::unite(i, xs.data(), xs.size(), ys.data(), ys.size(), u.data()));
+  return u;
+}
+
+// Size of xs ∪ ys, without writing it.
+template<typename T, typename A>
+auto vectorset_union_size(std::vector<T, A> const& xs, std::vector<T, A> const& ys) -> size_t {
+  return xs.size() + ys.size()
+    - simd::detail::intersection_size_scalar(xs.data(), xs.size(), ys.data(), ys.size());
+}
+
+} /* end namespace benchunion */
+
+#endif
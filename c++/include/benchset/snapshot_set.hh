@@ -0,0 +1,201 @@
+#ifndef SNAPSHOT_SET_HH_
+#define SNAPSHOT_SET_HH_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "benchset/myflat.hh"
+
+namespace my {
+
+/**
+ * A set for many readers and few writers, in the style of RCU: readers find
+ * keys in an immutable my::flat_set, the current snapshot, reached through
+ * an atomic pointer, without locks or writes to shared cache lines. Writers
+ * queue inserts and erases; 'publish' merges them into a copy of the
+ * snapshot and swaps the pointer, so an update costs one copy of the set
+ * however many keys it changes.
+ *
+ * Old snapshots are freed by epochs. A reader announces the global epoch in
+ * a slot of its own before loading the pointer, and clears it when done; a
+ * snapshot replaced in epoch e is freed once no reader announces an epoch
+ * up to e, as those that come later can only load its successors.
+ *
+ * Each reading thread gets its slot through a 'reader' handle, which it
+ * keeps for as long as it reads. Writers are serialized by a mutex.
+ */
+template<typename Key>
+class snapshot_set {
+ public:
+  using key_type = Key;
+  using snapshot_type = flat_set<Key>;
+  using size_type = size_t;
+
+  /** Operations queued before 'insert' and 'erase' publish on their own. */
+  static constexpr size_type default_batch_size = 1024;
+
+ private:
+  static constexpr uint64_t idle = std::numeric_limits<uint64_t>::max();
+
+  /** Epoch announced by one reader, on a cache line of its own. */
+  struct alignas(64) slot {
+    std::atomic<uint64_t> epoch{idle};
+    std::atomic<bool> taken{true};
+    slot* next = nullptr;
+  };
+
+ public:
+  /** Pins the current snapshot while it lives: its keys stay valid. */
+  class guard {
+   public:
+    guard(guard const&) = delete;
+    auto operator=(guard const&) -> guard& = delete;
+    ~guard() { m_slot->epoch.store(idle, std::memory_order_release); }
+
+    auto operator*() const noexcept -> snapshot_type const& { return *m_snapshot; }
+    auto operator->() const noexcept -> snapshot_type const* { return m_snapshot; }
+
+   private:
+    friend class snapshot_set;
+    guard(slot* s, snapshot_type const* snapshot) : m_slot(s), m_snapshot(snapshot) {}
+
+    slot* m_slot;
+    snapshot_type const* m_snapshot;
+  };
+
+  /** The slot of one reading thread. Handles must not be shared between threads. */
+  class reader {
+   public:
+    reader(reader&& other) noexcept : m_set(other.m_set), m_slot(std::exchange(other.m_slot, nullptr)) {}
+    reader(reader const&) = delete;
+    auto operator=(reader const&) -> reader& = delete;
+    ~reader() { if (m_slot) m_slot->taken.store(false, std::memory_order_release); }
+
+    /** Pins and returns the current snapshot. Guards of one reader must not overlap. */
+    auto pin() const -> guard {
+      m_slot->epoch.store(m_set->m_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+      return guard(m_slot, m_set->m_current.load(std::memory_order_seq_cst));
+    }
+
+    template<typename K = key_type>
+    auto contains(K const& k) const -> bool {
+      auto const s = pin();
+      return s->find(k) != s->end();
+    }
+
+   private:
+    friend class snapshot_set;
+    reader(snapshot_set const* set, slot* s) : m_set(set), m_slot(s) {}
+
+    snapshot_set const* m_set;
+    slot* m_slot;
+  };
+
+  explicit snapshot_set(snapshot_type keys = snapshot_type{}, size_type batch_size = default_batch_size)
+      : m_current(new snapshot_type(std::move(keys))), m_batch_size(batch_size) {}
+
+  snapshot_set(snapshot_set const&) = delete;
+  auto operator=(snapshot_set const&) -> snapshot_set& = delete;
+
+  /** There must be no readers left. */
+  ~snapshot_set() {
+    delete m_current.load();
+    for (auto const& r : m_retired) delete r.first;
+    for (auto* s = m_slots.load(); s;) delete std::exchange(s, s->next);
+  }
+
+  /** A handle for the calling thread to read with, reusing the slot of a destroyed one if any. */
+  auto make_reader() const -> reader {
+    for (auto* s = m_slots.load(std::memory_order_acquire); s; s = s->next) {
+      auto free = false;
+      if (s->taken.compare_exchange_strong(free, true, std::memory_order_acquire)) return reader(this, s);
+    }
+    auto* const s = new slot;
+    s->next = m_slots.load(std::memory_order_relaxed);
+    while (!m_slots.compare_exchange_weak(s->next, s, std::memory_order_release, std::memory_order_relaxed)) {}
+    return reader(this, s);
+  }
+
+  /** Queues the insertion of k; publishes when the batch is full. */
+  auto insert(key_type const& k) -> void { queue(k, true); }
+
+  /** Queues the removal of k; publishes when the batch is full. */
+  auto erase(key_type const& k) -> void { queue(k, false); }
+
+  /**
+   * Applies the queued operations to a copy of the snapshot, in one merge
+   * and one compaction, makes it current, and frees the snapshots no reader
+   * can see any more. Of several operations on one key, the last one wins.
+   */
+  auto publish() -> void {
+    std::lock_guard<std::mutex> lk(m_write);
+    publish_locked();
+  }
+
+  /** Operations queued and not yet published. */
+  auto pending() const -> size_type {
+    std::lock_guard<std::mutex> lk(m_write);
+    return m_pending.size();
+  }
+
+  /** Snapshots replaced but still possibly read. */
+  auto retired() const -> size_type {
+    std::lock_guard<std::mutex> lk(m_write);
+    return m_retired.size();
+  }
+
+ private:
+  auto queue(key_type const& k, bool insert) -> void {
+    std::lock_guard<std::mutex> lk(m_write);
+    m_pending.emplace_back(k, insert);
+    if (m_pending.size() >= m_batch_size) publish_locked();
+  }
+
+  auto publish_locked() -> void {
+    if (m_pending.empty()) return;
+    std::stable_sort(m_pending.begin(), m_pending.end(),
+                     [](auto const& a, auto const& b) { return a.first < b.first; });
+    auto inserts = vector<key_type>{};
+    auto erases = vector<key_type>{};
+    for (auto i = m_pending.begin(); i != m_pending.end(); ++i) {
+      if (std::next(i) != m_pending.end() && !(i->first < std::next(i)->first)) continue;
+      (i->second? inserts : erases).push_back(std::move(i->first));
+    }
+    m_pending.clear();
+
+    auto* const old = m_current.load(std::memory_order_relaxed);
+    auto* const next = new snapshot_type(*old);
+    next->erase_sorted(erases.begin(), erases.end());
+    next->insert_range(inserts.begin(), inserts.end());
+
+    m_current.store(next, std::memory_order_seq_cst);
+    m_retired.emplace_back(old, m_epoch.fetch_add(1, std::memory_order_seq_cst));
+    reclaim();
+  }
+
+  auto reclaim() -> void {
+    auto oldest = idle;
+    for (auto* s = m_slots.load(std::memory_order_acquire); s; s = s->next)
+      oldest = std::min(oldest, s->epoch.load(std::memory_order_seq_cst));
+    auto const end = std::partition(m_retired.begin(), m_retired.end(),
+                                    [oldest](auto const& r) { return r.second >= oldest; });
+    for (auto i = end; i != m_retired.end(); ++i) delete i->first;
+    m_retired.erase(end, m_retired.end());
+  }
+
+  std::atomic<snapshot_type*> m_current;
+  std::atomic<uint64_t> m_epoch{0};
+  mutable std::atomic<slot*> m_slots{nullptr};
+  size_type m_batch_size;
+  mutable std::mutex m_write;
+  vector<pair<key_type, bool>> m_pending;
+  vector<pair<snapshot_type*, uint64_t>> m_retired;
+};
+
+} /* end namespace my */
+
+#endif
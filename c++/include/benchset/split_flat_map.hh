@@ -0,0 +1,274 @@
+#ifndef SPLIT_FLAT_MAP_HH_
+#define SPLIT_FLAT_MAP_HH_
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include "benchset/myflat.hh"
+
+namespace my {
+
+/**
+ * A flat map keeping its keys and its values in two vectors, in the same
+ * order. The binary search of a lookup only touches the keys, so it stays as
+ * fast whatever the size of the values, and loads one value at the end.
+ *
+ * Iterating yields pairs of references to a key and its value, built on the
+ * fly: the elements are not stored as pairs anywhere.
+ */
+template<typename Key, typename Value>
+struct split_flat_map {
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = pair<key_type, mapped_type>;
+  using key_vector_type = vector<key_type>;
+  using mapped_vector_type = vector<mapped_type>;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using mapped_type_reference = mapped_type&;
+  /** What iterators point to: a key and its value, by reference. */
+  using reference = pair<key_type const&, mapped_type const&>;
+  using const_reference = reference;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = split_flat_map::value_type;
+    using difference_type = ptrdiff_t;
+    using reference = split_flat_map::reference;
+
+    /** Holds the pair of references that operator-> points to. */
+    struct pointer {
+      reference ref;
+      auto operator->() const -> reference const* { return &ref; }
+    };
+
+    const_iterator() = default;
+
+    auto operator*() const -> reference { return reference((*m_keys)[m_i], (*m_values)[m_i]); }
+    auto operator->() const -> pointer { return pointer{**this}; }
+    auto operator[](difference_type d) const -> reference { return *(*this + d); }
+
+    auto operator++() -> const_iterator& { ++m_i; return *this; }
+    auto operator++(int) -> const_iterator { auto it = *this; ++m_i; return it; }
+    auto operator--() -> const_iterator& { --m_i; return *this; }
+    auto operator--(int) -> const_iterator { auto it = *this; --m_i; return it; }
+    auto operator+=(difference_type d) -> const_iterator& { m_i += size_t(d); return *this; }
+    auto operator-=(difference_type d) -> const_iterator& { m_i -= size_t(d); return *this; }
+
+    friend auto operator+(const_iterator it, difference_type d) -> const_iterator { return it += d; }
+    friend auto operator+(difference_type d, const_iterator it) -> const_iterator { return it += d; }
+    friend auto operator-(const_iterator it, difference_type d) -> const_iterator { return it -= d; }
+    friend auto operator-(const_iterator a, const_iterator b) -> difference_type {
+      return difference_type(a.m_i) - difference_type(b.m_i);
+    }
+    friend auto operator==(const_iterator a, const_iterator b) -> bool { return a.m_i == b.m_i; }
+    friend auto operator!=(const_iterator a, const_iterator b) -> bool { return a.m_i != b.m_i; }
+    friend auto operator<(const_iterator a, const_iterator b) -> bool { return a.m_i < b.m_i; }
+    friend auto operator>(const_iterator a, const_iterator b) -> bool { return a.m_i > b.m_i; }
+    friend auto operator<=(const_iterator a, const_iterator b) -> bool { return a.m_i <= b.m_i; }
+    friend auto operator>=(const_iterator a, const_iterator b) -> bool { return a.m_i >= b.m_i; }
+
+    /** Position of the element in the key and value vectors. */
+    auto index() const noexcept -> size_type { return m_i; }
+
+   private:
+    friend struct split_flat_map;
+    const_iterator(key_vector_type const* keys, mapped_vector_type const* values, size_t i)
+        : m_keys(keys), m_values(values), m_i(i) {}
+
+    key_vector_type const* m_keys = nullptr;
+    mapped_vector_type const* m_values = nullptr;
+    size_t m_i = 0;
+  };
+  using iterator = const_iterator;
+  using reverse_iterator = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  split_flat_map() = default;
+
+  split_flat_map(std::initializer_list<value_type> const& ps) { insert_range(ps.begin(), ps.end()); }
+
+  template<typename It>
+  split_flat_map(It first, It last) { insert_range(first, last); }
+
+  /**
+   * Adopts 'keys' and 'values', of the same size, the keys sorted and
+   * without duplicates.
+   */
+  split_flat_map(ordered_unique_range_t, key_vector_type keys, mapped_vector_type values)
+      : m_keys(std::move(keys)), m_values(std::move(values)) {}
+
+  /** Returns whether the container is empty. */
+  auto empty() const noexcept -> bool { return m_keys.empty(); }
+
+  /** Returns how many elements are in the container. */
+  auto size() const noexcept -> size_type { return m_keys.size(); }
+
+  /** Returns the number of elements that the container has currently allocated space for. */
+  auto capacity() const noexcept -> size_type { return std::min(m_keys.capacity(), m_values.capacity()); }
+
+  /** Reserve memory for n elements. */
+  auto reserve(size_type n) {
+    m_keys.reserve(n);
+    m_values.reserve(n);
+  }
+
+  /** Shrinks the vectors to fit their elements. */
+  auto shrink_to_fit() {
+    m_keys.shrink_to_fit();
+    m_values.shrink_to_fit();
+  }
+
+  /** Returns the nth element. */
+  auto nth(size_type pos) const -> const_reference { return begin()[difference_type(pos)]; }
+
+  /** Returns the sorted keys. */
+  auto keys() const noexcept -> key_vector_type const& { return m_keys; }
+
+  /** Returns the values, in the order of their keys. */
+  auto values() const noexcept -> mapped_vector_type const& { return m_values; }
+
+  auto begin() const noexcept -> const_iterator { return const_iterator(&m_keys, &m_values, 0); }
+  auto cbegin() const noexcept -> const_iterator { return begin(); }
+  auto end() const noexcept -> const_iterator { return const_iterator(&m_keys, &m_values, size()); }
+  auto cend() const noexcept -> const_iterator { return end(); }
+  auto rbegin() const noexcept -> const_reverse_iterator { return const_reverse_iterator(end()); }
+  auto crbegin() const noexcept -> const_reverse_iterator { return rbegin(); }
+  auto rend() const noexcept -> const_reverse_iterator { return const_reverse_iterator(begin()); }
+  auto crend() const noexcept -> const_reverse_iterator { return rend(); }
+
+  /**
+   * Inserts the pairs of [first, last), in any order. Like insert, a pair
+   * whose key is already present is dropped. The new pairs are sorted on
+   * their own, then merged from the back into both vectors.
+   */
+  template<typename It>
+  auto insert_range(It first, It last) -> void {
+    auto ps = vector<value_type>(first, last);
+    auto const key_less = [](value_type const& a, value_type const& b) { return a.first < b.first; };
+    auto const key_equiv = [](value_type const& a, value_type const& b) { return a.first == b.first; };
+    std::stable_sort(ps.begin(), ps.end(), key_less);
+    ps.erase(std::unique(ps.begin(), ps.end(), key_equiv), ps.end());
+
+    auto i = size();
+    auto k = i;
+    for (auto x = size_t{0}, y = size_t{0}; y < ps.size();) {
+      if (x < i && m_keys[x] < ps[y].first) {
+        ++x;
+      } else {
+        if (x == i || ps[y].first < m_keys[x]) ++k;
+        else ++x;
+        ++y;
+      }
+    }
+    m_keys.resize(k);
+    m_values.resize(k);
+    for (auto y = ps.size(); k != i;) {
+      if (i > 0 && !(m_keys[i - 1] < ps[y - 1].first)) {
+        if (ps[y - 1].first == m_keys[i - 1]) --y;
+        --k, --i;
+        m_keys[k] = std::move(m_keys[i]);
+        m_values[k] = std::move(m_values[i]);
+      } else {
+        --k, --y;
+        m_keys[k] = std::move(ps[y].first);
+        m_values[k] = std::move(ps[y].second);
+      }
+    }
+  }
+
+  /**
+   * Finds the pair of key k, which can be of any type ordered against
+   * key_type. Only the key vector is searched.
+   */
+  template<typename K = key_type>
+  auto find(K const& k) const noexcept -> const_iterator {
+    auto const i = std::lower_bound(m_keys.begin(), m_keys.end(), k);
+    return i != m_keys.end() && *i == k? begin() + (i - m_keys.begin()) : end();
+  }
+
+  template<typename K = key_type>
+  auto count(K const& k) const noexcept -> size_type { return find(k) != end()? 1 : 0; }
+
+  /** Inserts p unless its key is present; returns where the key is, and whether p was inserted. */
+  auto insert(value_type const& p) -> pair<iterator, bool> {
+    auto const i = size_t(std::lower_bound(m_keys.begin(), m_keys.end(), p.first) - m_keys.begin());
+    if (i < size() && m_keys[i] == p.first) return pair<iterator, bool>(begin() + difference_type(i), false);
+    m_keys.insert(m_keys.begin() + difference_type(i), p.first);
+    m_values.insert(m_values.begin() + difference_type(i), p.second);
+    return pair<iterator, bool>(begin() + difference_type(i), true);
+  }
+
+  /** Like find, k is only converted to key_type when it is inserted. */
+  template<typename K = key_type>
+  auto operator[](K const& k) -> mapped_type_reference {
+    auto const i = size_t(std::lower_bound(m_keys.begin(), m_keys.end(), k) - m_keys.begin());
+    if (i == size() || !(m_keys[i] == k)) {
+      m_keys.insert(m_keys.begin() + difference_type(i), key_type(k));
+      m_values.insert(m_values.begin() + difference_type(i), mapped_type());
+    }
+    return m_values[i];
+  }
+
+  /** Removes the element at pos; returns the iterator to the one after it. */
+  auto erase(const_iterator pos) -> iterator { return erase(pos, pos + 1); }
+
+  /** Removes the elements of [first, last); returns the iterator to the one after them. */
+  auto erase(const_iterator first, const_iterator last) -> iterator {
+    m_keys.erase(m_keys.begin() + (first - begin()), m_keys.begin() + (last - begin()));
+    m_values.erase(m_values.begin() + (first - begin()), m_values.begin() + (last - begin()));
+    return begin() + (first - begin());
+  }
+
+  /** Removes the pair of key k, if present; returns how many pairs were removed. */
+  template<typename K = key_type>
+  auto erase(K const& k) -> size_type {
+    auto const i = find(k);
+    if (i == end()) return 0;
+    erase(i);
+    return 1;
+  }
+
+  /** Removes the pairs satisfying 'pred', given a reference, in one pass; returns how many were removed. */
+  template<typename Pred>
+  auto erase_if(Pred pred) -> size_type {
+    return compact([&](size_t i) { return pred(reference(m_keys[i], m_values[i])); });
+  }
+
+  /** Removes the pairs with a key in the sorted range [first, last), in one pass; returns how many were removed. */
+  template<typename It>
+  auto erase_sorted(It first, It last) -> size_type {
+    return compact([&](size_t i) {
+      while (first != last && *first < m_keys[i]) ++first;
+      return first != last && !(m_keys[i] < *first);
+    });
+  }
+
+ private:
+  /** Removes the elements at the indices, visited in order, that 'drop' is true for. */
+  template<typename Drop>
+  auto compact(Drop drop) -> size_type {
+    auto out = size_t{0};
+    for (auto i = size_t{0}; i < size(); ++i) {
+      if (drop(i)) continue;
+      if (out != i) {
+        m_keys[out] = std::move(m_keys[i]);
+        m_values[out] = std::move(m_values[i]);
+      }
+      ++out;
+    }
+    auto const n = size() - out;
+    m_keys.erase(m_keys.begin() + difference_type(out), m_keys.end());
+    m_values.erase(m_values.begin() + difference_type(out), m_values.end());
+    return n;
+  }
+
+  key_vector_type m_keys;
+  mapped_vector_type m_values;
+};
+
+} /* end namespace my */
+
+#endif
@@ -0,0 +1,286 @@
+#ifndef BENCH_STATIC_SEARCH_HH_
+#define BENCH_STATIC_SEARCH_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "benchset/simd_intersection.hh"
+
+// Read-only sets and maps built once from sorted keys, laid out for lookups
+// instead of for iteration. A layout fixes where each key goes and how to
+// search for the first key not less than a value:
+//
+//  - sorted_layout: the sorted array, searched by a branchless binary search
+//    that prefetches both possible next probes;
+//  - eytzinger_layout: the implicit binary tree in breadth-first order, where
+//    the 16 descendants four levels down share a cache line that is
+//    prefetched ahead of the search;
+//  - stree_layout: an implicit B-tree whose nodes each fill one cache line,
+//    searched with a vector compare per node (Khuong and Morin, Algorithmica).
+namespace benchunion {
+
+// No key is at least the value searched for.
+constexpr size_t no_slot = ~size_t{0};
+
+namespace static_detail {
+
+constexpr size_t cache_line = 64;
+
+// A node of the layouts spans a cache line only if the array starts on one.
+template<typename T>
+struct cache_aligned_allocator {
+  using value_type = T;
+
+  cache_aligned_allocator() = default;
+  template<typename U>
+  cache_aligned_allocator(cache_aligned_allocator<U> const&) noexcept {}
+
+  auto allocate(size_t n) -> T* {
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(cache_line)));
+  }
+  auto deallocate(T* p, size_t) noexcept -> void {
+    ::operator delete(p, std::align_val_t(cache_line));
+  }
+
+  friend auto operator==(cache_aligned_allocator, cache_aligned_allocator) -> bool { return true; }
+  friend auto operator!=(cache_aligned_allocator, cache_aligned_allocator) -> bool { return false; }
+};
+
+template<typename T>
+using aligned_vector = std::vector<T, cache_aligned_allocator<T>>;
+
+} /* end namespace static_detail */
+
+// Each layout has 'slots<T>(n)', the size of the array holding n keys, and
+// 'place<T>(n, f)', which calls f(slot, rank) to store the key of the given
+// rank at every slot.
+struct sorted_layout {
+  template<typename T>
+  static auto slots(size_t n) -> size_t { return n; }
+
+  template<typename T, typename F>
+  static auto place(size_t n, F&& f) -> void {
+    for (auto i = size_t{0}; i < n; ++i) f(i, i);
+  }
+
+  // The first key not less than x lies in [base, base + len): halving len
+  // moves base forward or not, with a conditional move instead of a branch.
+  template<typename T>
+  static auto lower_bound(T const* keys, size_t n, T const& x) -> size_t {
+    if (n == 0) return no_slot;
+    auto const* base = keys;
+    auto len = n;
+    while (len > 1) {
+      auto const half = len / 2;
+      __builtin_prefetch(base + len / 4);
+      __builtin_prefetch(base + half + len / 4);
+      base += (base[half - 1] < x)? half : 0;
+      len -= half;
+    }
+    auto const i = size_t(base - keys) + (*base < x);
+    return i < n? i : no_slot;
+  }
+};
+
+struct eytzinger_layout {
+  // Slot k has children 2k and 2k + 1; slot 0 is unused.
+  template<typename T>
+  static auto slots(size_t n) -> size_t { return n + 1; }
+
+  template<typename T, typename F>
+  static auto place(size_t n, F&& f) -> void {
+    f(0, 0);
+    auto rank = size_t{0};
+    fill(n, 1, rank, f);
+  }
+
+  // Walks down to a leaf, then back up past the right turns: the last left
+  // turn was at the answer.
+  template<typename T>
+  static auto lower_bound(T const* keys, size_t n, T const& x) -> size_t {
+    constexpr auto block = std::max<size_t>(static_detail::cache_line / sizeof(T), 1);
+    auto k = size_t{1};
+    while (k <= n) {
+      __builtin_prefetch(keys + k * block);
+      k = 2 * k + (keys[k] < x);
+    }
+    k >>= __builtin_ffsll(static_cast<long long>(~k));
+    return k == 0? no_slot : k;
+  }
+
+ private:
+  template<typename F>
+  static auto fill(size_t n, size_t k, size_t& rank, F& f) -> void {
+    if (k > n) return;
+    fill(n, 2 * k, rank, f);
+    f(k, rank++);
+    fill(n, 2 * k + 1, rank, f);
+  }
+};
+
+struct stree_layout {
+  // Keys per node: a cache line of them.
+  template<typename T>
+  static constexpr size_t node = std::max<size_t>(static_detail::cache_line / sizeof(T), 1);
+
+  // Node k has children k(B + 1) + 1 ... k(B + 1) + B + 1. The last node is
+  // padded with copies of the largest key, which come last in key order.
+  template<typename T>
+  static auto slots(size_t n) -> size_t { return (n + node<T> - 1) / node<T> * node<T>; }
+
+  template<typename T, typename F>
+  static auto place(size_t n, F&& f) -> void {
+    auto rank = size_t{0};
+    fill<node<T>>(n, slots<T>(n) / node<T>, 0, rank, f);
+  }
+
+  template<typename T>
+  static auto lower_bound(T const* keys, size_t n, T const& x) -> size_t {
+#ifdef BENCHSET_SIMD_X86
+    if constexpr (std::is_same_v<T, int32_t>) {
+      static auto const avx2 = simd::supported(simd::isa::avx2);
+      if (avx2) return lower_bound_avx2(keys, n, x);
+    }
+#endif
+    return search<node<T>>(keys, n, x, [](T const* ks, T const& v) {
+      auto r = size_t{0};
+      for (auto i = size_t{0}; i < node<T>; ++i) r += ks[i] < v;
+      return r;
+    });
+  }
+
+ private:
+  template<size_t B, typename F>
+  static auto fill(size_t n, size_t nodes, size_t k, size_t& rank, F& f) -> void {
+    if (k >= nodes) return;
+    for (auto i = size_t{0}; i < B; ++i) {
+      fill<B>(n, nodes, k * (B + 1) + i + 1, rank, f);
+      f(k * B + i, std::min(rank++, n - 1));
+    }
+    fill<B>(n, nodes, k * (B + 1) + B + 1, rank, f);
+  }
+
+  // At each node, 'rank' counts the keys less than x: the key after them is
+  // the best answer so far, and the child before it holds any better one.
+  template<size_t B, typename T, typename Rank>
+  __attribute__((always_inline))
+  static auto search(T const* keys, size_t n, T const& x, Rank&& rank) -> size_t {
+    auto const nodes = (n + B - 1) / B;
+    auto res = no_slot;
+    for (auto k = size_t{0}; k < nodes;) {
+      auto const i = rank(keys + k * B, x);
+      if (i < B) res = k * B + i;
+      k = k * (B + 1) + i + 1;
+    }
+    return res;
+  }
+
+#ifdef BENCHSET_SIMD_X86
+  __attribute__((target("avx2")))
+  static auto lower_bound_avx2(int32_t const* keys, size_t n, int32_t x) -> size_t {
+    return search<16>(keys, n, x, [](int32_t const* ks, int32_t v) __attribute__((target("avx2"))) {
+      auto const xv = _mm256_set1_epi32(v);
+      auto const lo = _mm256_cmpgt_epi32(xv, _mm256_load_si256(reinterpret_cast<__m256i const*>(ks)));
+      auto const hi = _mm256_cmpgt_epi32(xv, _mm256_load_si256(reinterpret_cast<__m256i const*>(ks + 8)));
+      auto const m = unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(lo)))
+        | unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(hi))) << 8;
+      return size_t(__builtin_popcount(m));
+    });
+  }
+#endif
+};
+
+// A set of the keys given in increasing order at construction.
+template<typename T, typename Layout>
+class static_set {
+ public:
+  using value_type = T;
+
+  static_set() = default;
+
+  explicit static_set(std::vector<T> const& sorted) : m_size(sorted.size()) {
+    if (sorted.empty()) return;
+    m_keys.resize(Layout::template slots<T>(m_size));
+    Layout::template place<T>(m_size, [&](size_t slot, size_t rank) { m_keys[slot] = sorted[rank]; });
+  }
+
+  auto size() const noexcept -> size_t { return m_size; }
+  auto empty() const noexcept -> bool { return m_size == 0; }
+
+  // Bytes held by the set, including the object itself.
+  auto bytes() const noexcept -> size_t { return sizeof(*this) + m_keys.capacity() * sizeof(T); }
+
+  // The first key not less than x, or nullptr.
+  auto lower_bound(T const& x) const -> T const* {
+    auto const s = Layout::lower_bound(m_keys.data(), m_size, x);
+    return s == no_slot? nullptr : &m_keys[s];
+  }
+
+  auto contains(T const& x) const -> bool {
+    auto const* k = lower_bound(x);
+    return k && !(x < *k);
+  }
+
+ private:
+  size_t m_size = 0;
+  static_detail::aligned_vector<T> m_keys;
+};
+
+// A map from the keys of pairs given in increasing key order. The values are
+// stored apart, in the order of the keys, so the searches only touch keys.
+template<typename Key, typename Value, typename Layout>
+class static_map {
+ public:
+  using key_type = Key;
+  using mapped_type = Value;
+
+  static_map() = default;
+
+  explicit static_map(std::vector<std::pair<Key, Value>> const& sorted) : m_size(sorted.size()) {
+    if (sorted.empty()) return;
+    m_keys.resize(Layout::template slots<Key>(m_size));
+    m_values.resize(m_keys.size());
+    Layout::template place<Key>(m_size, [&](size_t slot, size_t rank) {
+      m_keys[slot] = sorted[rank].first;
+      m_values[slot] = sorted[rank].second;
+    });
+  }
+
+  auto size() const noexcept -> size_t { return m_size; }
+  auto empty() const noexcept -> bool { return m_size == 0; }
+
+  // The value of key k, or nullptr.
+  auto find(Key const& k) const -> Value const* {
+    auto const s = Layout::lower_bound(m_keys.data(), m_size, k);
+    return s != no_slot && !(k < m_keys[s])? &m_values[s] : nullptr;
+  }
+
+  auto contains(Key const& k) const -> bool { return find(k) != nullptr; }
+
+ private:
+  size_t m_size = 0;
+  static_detail::aligned_vector<Key> m_keys;
+  std::vector<Value> m_values;
+};
+
+template<typename T>
+using branchless_set = static_set<T, sorted_layout>;
+template<typename T>
+using eytzinger_set = static_set<T, eytzinger_layout>;
+template<typename T>
+using stree_set = static_set<T, stree_layout>;
+
+template<typename Key, typename Value>
+using branchless_map = static_map<Key, Value, sorted_layout>;
+template<typename Key, typename Value>
+using eytzinger_map = static_map<Key, Value, eytzinger_layout>;
+template<typename Key, typename Value>
+using stree_map = static_map<Key, Value, stree_layout>;
+
+} /* end namespace benchunion */
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef STRING_FLAT_MAP_HH_
+#define STRING_FLAT_MAP_HH_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "benchset/myflat.hh"
+#include "benchset/simd_intersection.hh"
+
+namespace my {
+
+/**
+ * The first 8 bytes of a key, zero-padded, as a number ordered like the keys:
+ * big-endian, with the sign bit flipped so that signed compares work. Keys
+ * with different prefixes compare like their prefixes.
+ */
+inline auto key_prefix(std::string_view k) noexcept -> int64_t {
+  auto p = uint64_t{0};
+  auto const n = std::min<size_t>(k.size(), 8);
+  for (auto i = size_t{0}; i < n; ++i) p |= uint64_t(static_cast<unsigned char>(k[i])) << (56 - 8 * i);
+  return static_cast<int64_t>(p ^ (uint64_t{1} << 63));
+}
+
+/**
+ * A flat map from strings that keeps the prefix of every key in an array of
+ * its own. A lookup binary searches the prefixes, 8 to a cache line and one
+ * compare each, and ends with one SIMD compare of the last 8; only the keys
+ * sharing the prefix of the one searched for are compared as strings.
+ *
+ * The prefixes start after the bytes all the keys have in common, like the
+ * scheme and host of URLs, which would otherwise make them all equal.
+ */
+template<typename Value>
+class string_flat_map : public flat_tree<pair<std::string, Value>> {
+ public:
+  using key_type = std::string;
+  using mapped_type = Value;
+  using value_type = pair<key_type, mapped_type>;
+  using vector_type = vector<value_type>;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using mapped_type_reference = mapped_type&;
+  using iterator = typename flat_tree<value_type>::iterator;
+  using const_iterator = typename flat_tree<value_type>::const_iterator;
+
+  string_flat_map() { index(); }
+
+  template<typename It>
+  string_flat_map(It first, It last) : flat_tree<value_type>(sorted_unique(first, last)) { index(); }
+
+  /** Adopts 'ps', which must be sorted by key and without duplicate keys. */
+  string_flat_map(ordered_unique_range_t, vector_type ps) : flat_tree<value_type>(std::move(ps)) { index(); }
+
+  /** Finds the pair of key k, given as a std::string, a std::string_view or a C string. */
+  auto find(std::string_view k) const -> const_iterator {
+    auto const i = lower_bound(k);
+    return i < this->size() && this->m_vals[i].first == k? this->begin() + i : this->end();
+  }
+
+  auto insert(value_type const& p) -> pair<iterator, bool> {
+    auto const i = lower_bound(p.first);
+    if (i < this->size() && this->m_vals[i].first == p.first)
+      return pair<iterator, bool>(this->begin() + i, false);
+    insert_at(i, p);
+    return pair<iterator, bool>(this->begin() + i, true);
+  }
+
+  auto operator[](std::string_view k) -> mapped_type_reference {
+    auto const i = lower_bound(k);
+    if (i == this->size() || this->m_vals[i].first != k) insert_at(i, value_type{key_type(k), mapped_type()});
+    return this->m_vals[i].second;
+  }
+
+  /** The remaining keys still share the common bytes: their prefixes stay. */
+  auto erase(const_iterator pos) -> iterator {
+    m_prefixes.erase(m_prefixes.begin() + (pos - this->begin()));
+    return this->m_vals.erase(pos);
+  }
+
+  auto erase(const_iterator first, const_iterator last) -> iterator {
+    m_prefixes.erase(m_prefixes.begin() + (first - this->begin()), m_prefixes.begin() + (last - this->begin()));
+    return this->m_vals.erase(first, last);
+  }
+
+  auto erase(std::string_view k) -> size_type {
+    auto const i = lower_bound(k);
+    if (i == this->size() || this->m_vals[i].first != k) return 0;
+    erase(this->begin() + i);
+    return 1;
+  }
+
+  template<typename Pred>
+  auto erase_if(Pred pred) -> size_type {
+    auto const n = flat_tree<value_type>::erase_if(pred);
+    if (n > 0) index();
+    return n;
+  }
+
+  /** Removes the pairs with a key in the sorted range [first, last), in one pass. */
+  template<typename It>
+  auto erase_sorted(It first, It last) -> size_type {
+    auto const n = this->remove_sorted(first, last, [](value_type const& p) -> key_type const& { return p.first; });
+    if (n > 0) index();
+    return n;
+  }
+
+ private:
+  /** The prefixes end with 'pad' entries past the last key, never less than a prefix. */
+  static constexpr size_t pad = 8;
+  static constexpr int64_t sentinel = std::numeric_limits<int64_t>::max();
+
+  static constexpr auto key_less = [](value_type const& a, value_type const& b) { return a.first < b.first; };
+
+  template<typename It>
+  static auto sorted_unique(It first, It last) -> vector_type {
+    auto ps = vector_type(first, last);
+    std::stable_sort(ps.begin(), ps.end(), key_less);
+    auto const equiv = [](value_type const& a, value_type const& b) { return a.first == b.first; };
+    ps.erase(std::unique(ps.begin(), ps.end(), equiv), ps.end());
+    return ps;
+  }
+
+  /** The keys being sorted, their common bytes are those of the first and last ones. */
+  auto index() -> void {
+    m_common.clear();
+    if (!this->empty()) {
+      auto const& a = this->m_vals.front().first;
+      auto const& b = this->m_vals.back().first;
+      auto const m = std::mismatch(a.begin(), a.begin() + std::min(a.size(), b.size()), b.begin());
+      m_common.assign(a.begin(), m.first);
+    }
+    m_prefixes.clear();
+    m_prefixes.reserve(this->size() + pad);
+    for (auto const& p : this->m_vals) m_prefixes.push_back(key_prefix(std::string_view(p.first).substr(m_common.size())));
+    m_prefixes.insert(m_prefixes.end(), pad, sentinel);
+  }
+
+  /** A key without the common bytes changes them: the prefixes are made again. */
+  auto insert_at(size_t i, value_type const& p) -> void {
+    this->m_vals.insert(this->m_vals.begin() + i, p);
+    if (std::string_view(p.first).substr(0, m_common.size()) == m_common && this->size() > 1)
+      m_prefixes.insert(m_prefixes.begin() + i, key_prefix(std::string_view(p.first).substr(m_common.size())));
+    else
+      index();
+  }
+
+  /** Index of the first key not less than k. */
+  auto lower_bound(std::string_view k) const -> size_t {
+    auto const n = this->size();
+    // A key without the common bytes is before or after all the others.
+    if (auto const c = k.substr(0, m_common.size()).compare(m_common); c != 0) return c < 0? 0 : n;
+    auto const kp = key_prefix(k.substr(m_common.size()));
+    auto const i = prefix_lower_bound(kp);
+    if (i == n || m_prefixes[i] != kp) return i;
+    // Only the keys sharing the prefix are left: usually just the one.
+    auto const j = i + 1 == n || m_prefixes[i + 1] != kp? i + 1
+      : size_t(std::upper_bound(m_prefixes.begin() + i, m_prefixes.begin() + n, kp) - m_prefixes.begin());
+    auto const it = std::lower_bound(this->m_vals.begin() + i, this->m_vals.begin() + j, k,
+                                     [](value_type const& p, std::string_view x) { return p.first < x; });
+    return size_t(it - this->m_vals.begin());
+  }
+
+  /**
+   * Branchless binary search down to at most 'pad' candidates, then one
+   * count of the prefixes less than kp among the next 'pad': those past the
+   * candidates are not less, real or padding.
+   */
+  auto prefix_lower_bound(int64_t kp) const -> size_t {
+    auto const* base = m_prefixes.data();
+    auto len = this->size();
+    while (len > pad) {
+      auto const half = len / 2;
+      base += (base[half - 1] < kp)? half : 0;
+      len -= half;
+    }
+    return size_t(base - m_prefixes.data()) + count_less(base, kp);
+  }
+
+  static auto count_less(int64_t const* ps, int64_t kp) -> size_t {
+#ifdef BENCHSET_SIMD_X86
+    static auto const avx2 = benchunion::simd::supported(benchunion::simd::isa::avx2);
+    if (avx2) return count_less_avx2(ps, kp);
+#endif
+    auto r = size_t{0};
+    for (auto i = size_t{0}; i < pad; ++i) r += ps[i] < kp;
+    return r;
+  }
+
+#ifdef BENCHSET_SIMD_X86
+  __attribute__((target("avx2")))
+  static auto count_less_avx2(int64_t const* ps, int64_t kp) -> size_t {
+    auto const k = _mm256_set1_epi64x(kp);
+    auto const lo = _mm256_cmpgt_epi64(k, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(ps)));
+    auto const hi = _mm256_cmpgt_epi64(k, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(ps + 4)));
+    auto const m = unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(lo)))
+      | unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(hi))) << 4;
+    return size_t(__builtin_popcount(m));
+  }
+#endif
+
+  std::string m_common;
+  std::vector<int64_t> m_prefixes;
+};
+
+} /* end namespace my */
+
+#endif
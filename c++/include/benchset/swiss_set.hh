@@ -0,0 +1,362 @@
+#ifndef BENCH_SWISS_SET_HH_
+#define BENCH_SWISS_SET_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// An open-addressing hash set with its elements in one array, next to an
+// array of control bytes: one byte per slot, empty or holding 7 bits of the
+// hash of the element (Swiss tables, Abseil). A lookup compares 16 control
+// bytes with one vector compare and only looks at the elements whose byte
+// matches.
+//
+// The probing is linear from the home slot of the element, 16 slots at a
+// time. Erasing shifts the following elements of the cluster back instead of
+// leaving a tombstone, so lookups never get slower as elements are erased.
+namespace benchunion {
+
+namespace swiss_detail {
+
+constexpr size_t group = 16;
+constexpr int8_t empty = -128;
+
+// Bit i is set when byte i of the group is 'b'.
+#ifdef __SSE2__
+inline auto match(int8_t const* ctrl, int8_t b) -> uint32_t {
+  auto const g = _mm_loadu_si128(reinterpret_cast<__m128i const*>(ctrl));
+  return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(b))));
+}
+#else
+inline auto match(int8_t const* ctrl, int8_t b) -> uint32_t {
+  auto m = uint32_t{0};
+  for (auto i = size_t{0}; i < group; ++i) m |= uint32_t(ctrl[i] == b) << i;
+  return m;
+}
+#endif
+
+// Spreads the bits of hashes that are poor on their own, like the identity
+// std::hash of the integers.
+inline auto mix(size_t h) -> uint64_t {
+  auto x = uint64_t(h) * 0x9e3779b97f4a7c15ull;
+  return x ^ (x >> 32);
+}
+
+} /* end namespace swiss_detail */
+
+template<typename T, typename Hash = std::hash<T>, typename Eq = std::equal_to<T>>
+class swiss_set {
+ public:
+  using value_type = T;
+  using key_type = T;
+  using size_type = size_t;
+  using hasher = Hash;
+  using key_equal = Eq;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = ptrdiff_t;
+    using pointer = T const*;
+    using reference = T const&;
+
+    const_iterator() = default;
+
+    auto operator*() const -> reference { return m_set->m_slots[m_i]; }
+    auto operator->() const -> pointer { return &m_set->m_slots[m_i]; }
+    auto operator++() -> const_iterator& { m_i = m_set->next_full(m_i + 1); return *this; }
+    auto operator++(int) -> const_iterator { auto it = *this; ++*this; return it; }
+    friend auto operator==(const_iterator a, const_iterator b) -> bool { return a.m_i == b.m_i; }
+    friend auto operator!=(const_iterator a, const_iterator b) -> bool { return a.m_i != b.m_i; }
+
+   private:
+    friend class swiss_set;
+    const_iterator(swiss_set const* s, size_t i) : m_set(s), m_i(i) {}
+
+    swiss_set const* m_set = nullptr;
+    size_t m_i = 0;
+  };
+  using iterator = const_iterator;
+
+  explicit swiss_set(Hash hash = Hash{}, Eq eq = Eq{}) : m_hash(std::move(hash)), m_eq(std::move(eq)) {}
+
+  template<typename It>
+  swiss_set(It first, It last, Hash hash = Hash{}, Eq eq = Eq{}) : swiss_set(std::move(hash), std::move(eq)) {
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                    typename std::iterator_traits<It>::iterator_category>)
+      reserve(size_t(std::distance(first, last)));
+    for (; first != last; ++first) insert(*first);
+  }
+
+  swiss_set(swiss_set const& other) : swiss_set(other.m_hash, other.m_eq) {
+    reserve(other.size());
+    for (auto const& x : other) insert(x);
+  }
+
+  swiss_set(swiss_set&& other) noexcept { swap(other); }
+
+  auto operator=(swiss_set other) -> swiss_set& {
+    swap(other);
+    return *this;
+  }
+
+  ~swiss_set() { release(); }
+
+  auto swap(swiss_set& other) noexcept -> void {
+    using std::swap;
+    swap(m_ctrl, other.m_ctrl);
+    swap(m_slots, other.m_slots);
+    swap(m_capacity, other.m_capacity);
+    swap(m_size, other.m_size);
+    swap(m_hash, other.m_hash);
+    swap(m_eq, other.m_eq);
+  }
+
+  auto empty() const noexcept -> bool { return m_size == 0; }
+  auto size() const noexcept -> size_type { return m_size; }
+  auto capacity() const noexcept -> size_type { return m_capacity; }
+
+  // Bytes held by the set, including the object itself.
+  auto bytes() const noexcept -> size_t {
+    return sizeof(*this) + (m_capacity == 0? 0 : m_capacity * sizeof(T) + m_capacity + swiss_detail::group);
+  }
+
+  auto begin() const -> const_iterator { return {this, next_full(0)}; }
+  auto end() const -> const_iterator { return {this, m_capacity}; }
+
+  auto find(T const& x) const -> const_iterator { return {this, find_slot(x)}; }
+  auto count(T const& x) const -> size_type { return find_slot(x) != m_capacity; }
+  auto contains(T const& x) const -> bool { return find_slot(x) != m_capacity; }
+
+  // Room for n elements without rehashing.
+  auto reserve(size_type n) -> void {
+    auto cap = swiss_detail::group;
+    while (cap * 7 / 8 < n) cap *= 2;
+    if (cap > m_capacity) rehash(cap);
+  }
+
+  auto insert(T const& x) -> std::pair<const_iterator, bool> { return emplace(x); }
+  auto insert(T&& x) -> std::pair<const_iterator, bool> { return emplace(std::move(x)); }
+
+  template<typename U>
+  auto emplace(U&& x) -> std::pair<const_iterator, bool> {
+    auto const i = find_slot(x);
+    if (i != m_capacity) return {{this, i}, false};
+    if ((m_size + 1) > m_capacity * 7 / 8) reserve(m_size + 1);
+    auto const h = swiss_detail::mix(m_hash(x));
+    auto const j = free_slot(h);
+    ::new (static_cast<void*>(m_slots + j)) T(std::forward<U>(x));
+    set_ctrl(j, int8_t(h & 0x7f));
+    ++m_size;
+    return {{this, j}, true};
+  }
+
+  auto erase(T const& x) -> size_type {
+    auto const i = find_slot(x);
+    if (i == m_capacity) return 0;
+    erase_slot(i);
+    return 1;
+  }
+
+  // Erases the elements satisfying pred, in one pass over the slots. An
+  // erase may shift a later element into the slot, which is looked at again;
+  // elements shifted from the start of the array, past its end, were already
+  // kept.
+  template<typename Pred>
+  auto erase_if(Pred pred) -> size_type {
+    auto const before = m_size;
+    for (auto i = size_t{0}; i < m_capacity;) {
+      if (m_ctrl[i] != swiss_detail::empty && pred(std::as_const(m_slots[i]))) erase_slot(i);
+      else ++i;
+    }
+    return before - m_size;
+  }
+
+  auto clear() -> void {
+    for (auto i = size_t{0}; i < m_capacity; ++i)
+      if (m_ctrl[i] != swiss_detail::empty) m_slots[i].~T();
+    if (m_ctrl) std::memset(m_ctrl, swiss_detail::empty, m_capacity + swiss_detail::group);
+    m_size = 0;
+  }
+
+ private:
+  auto home(uint64_t h) const -> size_t { return size_t(h >> 7) & (m_capacity - 1); }
+
+  // The control bytes of slots 0..15 are repeated after the last slot, so a
+  // group can be loaded at any slot.
+  auto set_ctrl(size_t i, int8_t b) -> void {
+    m_ctrl[i] = b;
+    if (i < swiss_detail::group) m_ctrl[m_capacity + i] = b;
+  }
+
+  auto find_slot(T const& x) const -> size_t {
+    if (m_size == 0) return m_capacity;
+    auto const h = swiss_detail::mix(m_hash(x));
+    auto const tag = int8_t(h & 0x7f);
+    for (auto pos = home(h);; pos = (pos + swiss_detail::group) & (m_capacity - 1)) {
+      for (auto m = swiss_detail::match(m_ctrl + pos, tag); m; m &= m - 1) {
+        auto const i = (pos + size_t(__builtin_ctz(m))) & (m_capacity - 1);
+        if (m_eq(m_slots[i], x)) return i;
+      }
+      if (swiss_detail::match(m_ctrl + pos, swiss_detail::empty)) return m_capacity;
+    }
+  }
+
+  // The first empty slot from the home slot: lookups stop at the first group
+  // holding an empty slot, which cannot come before this one.
+  auto free_slot(uint64_t h) const -> size_t {
+    for (auto pos = home(h);; pos = (pos + swiss_detail::group) & (m_capacity - 1)) {
+      if (auto const m = swiss_detail::match(m_ctrl + pos, swiss_detail::empty))
+        return (pos + size_t(__builtin_ctz(m))) & (m_capacity - 1);
+    }
+  }
+
+  auto next_full(size_t i) const -> size_t {
+    while (i < m_capacity && m_ctrl[i] == swiss_detail::empty) ++i;
+    return i;
+  }
+
+  // Backward shift: every later element of the cluster whose home slot is
+  // not between the hole and itself moves into the hole.
+  auto erase_slot(size_t i) -> void {
+    auto const mask = m_capacity - 1;
+    for (auto j = (i + 1) & mask; m_ctrl[j] != swiss_detail::empty; j = (j + 1) & mask) {
+      auto const k = home(swiss_detail::mix(m_hash(m_slots[j])));
+      auto const stays = i < j? (i < k && k <= j) : (i < k || k <= j);
+      if (stays) continue;
+      m_slots[i] = std::move(m_slots[j]);
+      set_ctrl(i, m_ctrl[j]);
+      i = j;
+    }
+    m_slots[i].~T();
+    set_ctrl(i, swiss_detail::empty);
+    --m_size;
+  }
+
+  auto rehash(size_t cap) -> void {
+    auto old = swiss_set(m_hash, m_eq);
+    swap(old);
+    m_capacity = cap;
+    m_slots = std::allocator<T>{}.allocate(cap);
+    m_ctrl = new int8_t[cap + swiss_detail::group];
+    std::memset(m_ctrl, swiss_detail::empty, cap + swiss_detail::group);
+    for (auto i = size_t{0}; i < old.m_capacity; ++i) {
+      if (old.m_ctrl[i] == swiss_detail::empty) continue;
+      auto const h = swiss_detail::mix(m_hash(old.m_slots[i]));
+      auto const j = free_slot(h);
+      ::new (static_cast<void*>(m_slots + j)) T(std::move(old.m_slots[i]));
+      set_ctrl(j, int8_t(h & 0x7f));
+      ++m_size;
+    }
+  }
+
+  auto release() -> void {
+    if (!m_ctrl) return;
+    clear();
+    std::allocator<T>{}.deallocate(m_slots, m_capacity);
+    delete[] m_ctrl;
+    m_ctrl = nullptr;
+    m_slots = nullptr;
+    m_capacity = 0;
+  }
+
+  int8_t* m_ctrl = nullptr;
+  T* m_slots = nullptr;
+  size_t m_capacity = 0;
+  size_t m_size = 0;
+  Hash m_hash;
+  Eq m_eq;
+};
+
+template<typename T, typename Hash, typename Eq>
+auto swissset_union(swiss_set<T, Hash, Eq> const& xs,
+                    swiss_set<T, Hash, Eq> const& ys) -> swiss_set<T, Hash, Eq> {
+  if (xs.size() < ys.size())
+    return swissset_union(ys, xs);
+
+  auto u = xs;
+  u.reserve(xs.size() + ys.size());
+  for (auto const& y : ys) u.insert(y);
+  return u;
+}
+
+// The forms below skip the result set, as those of union.hh and
+// intersection.hh: the '_into' ones write the elements to 'out', in no
+// particular order, the '_size' ones only count them and the '_inplace' ones
+// update xs.
+
+// The elements of xs, then those of ys missing from xs.
+template<typename T, typename Hash, typename Eq, typename Out>
+auto swissset_union_into(swiss_set<T, Hash, Eq> const& xs, swiss_set<T, Hash, Eq> const& ys, Out out) -> Out {
+  out = std::copy(xs.begin(), xs.end(), out);
+  for (auto const& y : ys) if (!xs.contains(y)) *out++ = y;
+  return out;
+}
+
+template<typename T, typename Hash, typename Eq>
+auto swissset_union_size(swiss_set<T, Hash, Eq> const& xs, swiss_set<T, Hash, Eq> const& ys) -> size_t {
+  if (xs.size() < ys.size())
+    return swissset_union_size(ys, xs);
+
+  auto n = xs.size();
+  for (auto const& y : ys) n += !xs.contains(y);
+  return n;
+}
+
+template<typename T, typename Hash, typename Eq>
+auto swissset_union_inplace(swiss_set<T, Hash, Eq>& xs, swiss_set<T, Hash, Eq> const& ys) -> void {
+  xs.reserve(xs.size() + ys.size());
+  for (auto const& y : ys) xs.insert(y);
+}
+
+template<typename T, typename Hash, typename Eq>
+auto swissset_intersection(swiss_set<T, Hash, Eq> const& xs,
+                           swiss_set<T, Hash, Eq> const& ys) -> swiss_set<T, Hash, Eq> {
+  if (xs.size() > ys.size())
+    return swissset_intersection(ys, xs);
+
+  auto inter = swiss_set<T, Hash, Eq>{};
+  inter.reserve(xs.size());
+  for (auto const& x : xs) if (ys.contains(x)) inter.insert(x);
+  return inter;
+}
+
+template<typename T, typename Hash, typename Eq, typename Out>
+auto swissset_intersection_into(swiss_set<T, Hash, Eq> const& xs, swiss_set<T, Hash, Eq> const& ys, Out out) -> Out {
+  if (xs.size() > ys.size())
+    return swissset_intersection_into(ys, xs, out);
+
+  for (auto const& x : xs) if (ys.contains(x)) *out++ = x;
+  return out;
+}
+
+template<typename T, typename Hash, typename Eq>
+auto swissset_intersection_size(swiss_set<T, Hash, Eq> const& xs, swiss_set<T, Hash, Eq> const& ys) -> size_t {
+  if (xs.size() > ys.size())
+    return swissset_intersection_size(ys, xs);
+
+  auto n = size_t{0};
+  for (auto const& x : xs) n += ys.contains(x);
+  return n;
+}
+
+template<typename T, typename Hash, typename Eq>
+auto swissset_intersection_inplace(swiss_set<T, Hash, Eq>& xs, swiss_set<T, Hash, Eq> const& ys) -> void {
+  xs.erase_if([&](T const& x) { return !ys.contains(x); });
+}
+
+} /* end namespace benchunion */
+
+#endif
@@ -2,6 +2,7 @@
 #define BENCH_UNION_HH_
 
 #include <algorithm>
+#include <iterator>
 #include <vector>
 #include <set>
 #include <unordered_set>
@@ -10,10 +11,11 @@
 
 namespace benchunion {
 
-template<typename T>
-auto flatset_union(boost::container::flat_set<T> const& xs,
-                   boost::container::flat_set<T> const& ys) -> boost::container::flat_set<T> {
-  auto u = boost::container::flat_set<T>{};
+template<typename T, typename A>
+auto flatset_union(boost::container::flat_set<T, std::less<T>, A> const& xs,
+                   boost::container::flat_set<T, std::less<T>, A> const& ys)
+                   -> boost::container::flat_set<T, std::less<T>, A> {
+  auto u = boost::container::flat_set<T, std::less<T>, A>(xs.get_allocator());
   u.reserve(xs.size() + ys.size());
   auto const xs_end = xs.end(), ys_end = ys.end();
   auto xs_it = xs.begin(), ys_it = ys.begin();
@@ -33,10 +35,11 @@ auto flatset_union(boost::container::flat_set<T> const& xs,
   return u;
 }
 
-template<typename T>
-auto flatset_union_eh(boost::container::flat_set<T> const& xs,
-                      boost::container::flat_set<T> const& ys) -> boost::container::flat_set<T> {
-  auto u = boost::container::flat_set<T>{};
+template<typename T, typename A>
+auto flatset_union_eh(boost::container::flat_set<T, std::less<T>, A> const& xs,
+                      boost::container::flat_set<T, std::less<T>, A> const& ys)
+                      -> boost::container::flat_set<T, std::less<T>, A> {
+  auto u = boost::container::flat_set<T, std::less<T>, A>(xs.get_allocator());
   u.reserve(xs.size() + ys.size());
   auto const xs_end = xs.end(), ys_end = ys.end();
   auto xs_it = xs.begin(), ys_it = ys.begin();
@@ -56,10 +59,10 @@ auto flatset_union_eh(boost::container::flat_set<T> const& xs,
   return u;
 }
 
-template<typename T>
-auto stdset_union(std::set<T> const& xs,
-                  std::set<T> const& ys) -> std::set<T> {
-  auto u = std::set<T>{};
+template<typename T, typename A>
+auto stdset_union(std::set<T, std::less<T>, A> const& xs,
+                  std::set<T, std::less<T>, A> const& ys) -> std::set<T, std::less<T>, A> {
+  auto u = std::set<T, std::less<T>, A>(xs.get_allocator());
   auto const xs_end = xs.end(), ys_end = ys.end();
   auto xs_it = xs.begin(), ys_it = ys.begin();
 
@@ -78,10 +81,10 @@ auto stdset_union(std::set<T> const& xs,
   return u;
 }
 
-template<typename T>
-auto stdset_union_eh(std::set<T> const& xs,
-                     std::set<T> const& ys) -> std::set<T> {
-  auto u = std::set<T>{};
+template<typename T, typename A>
+auto stdset_union_eh(std::set<T, std::less<T>, A> const& xs,
+                     std::set<T, std::less<T>, A> const& ys) -> std::set<T, std::less<T>, A> {
+  auto u = std::set<T, std::less<T>, A>(xs.get_allocator());
   auto const xs_end = xs.end(), ys_end = ys.end();
   auto xs_it = xs.begin(), ys_it = ys.begin();
 
@@ -100,9 +103,9 @@ auto stdset_union_eh(std::set<T> const& xs,
   return u;
 }
 
-template<typename T>
-auto stduset_union(std::unordered_set<T> const& xs,
-                   std::unordered_set<T> const& ys) -> std::unordered_set<T> {
+template<typename T, typename H, typename E, typename A>
+auto stduset_union(std::unordered_set<T, H, E, A> const& xs,
+                   std::unordered_set<T, H, E, A> const& ys) -> std::unordered_set<T, H, E, A> {
   if (xs.size() < ys.size())
     return stduset_union(ys, xs);
 
@@ -111,10 +114,10 @@ auto stduset_union(std::unordered_set<T> const& xs,
   return u;
 }
 
-template<typename T>
-auto sorted_vector_union(std::vector<T> const& xs,
-                         std::vector<T> const& ys) -> std::vector<T> {
-  auto u = std::vector<T>{};
+template<typename T, typename A>
+auto sorted_vector_union(std::vector<T, A> const& xs,
+                         std::vector<T, A> const& ys) -> std::vector<T, A> {
+  auto u = std::vector<T, A>(xs.get_allocator());
   u.reserve(std::max(xs.size(), ys.size()));
   auto const xs_end = xs.end(), ys_end = ys.end();
   auto xs_it = xs.begin(), ys_it = ys.begin();
@@ -135,10 +138,10 @@ auto sorted_vector_union(std::vector<T> const& xs,
 }
 
 
-template<typename T>
-auto vectorset_union(std::vector<T> const& xs,
-                     std::vector<T> const& ys) -> std::vector<T> {
-  auto u = std::vector<T>{};
+template<typename T, typename A>
+auto vectorset_union(std::vector<T, A> const& xs,
+                     std::vector<T, A> const& ys) -> std::vector<T, A> {
+  auto u = std::vector<T, A>(xs.get_allocator());
   u.reserve(xs.size() + ys.size());
   auto const xs_end = xs.end(), ys_end = ys.end();
   auto xs_it = xs.begin(), ys_it = ys.begin();
@@ -158,10 +161,10 @@ auto vectorset_union(std::vector<T> const& xs,
   return u;
 }
 
-template<typename T>
-auto vectorset_union_noback(std::vector<T> const& xs,
-                            std::vector<T> const& ys) -> std::vector<T> {
-  auto u = std::vector<T>{};
+template<typename T, typename A>
+auto vectorset_union_noback(std::vector<T, A> const& xs,
+                            std::vector<T, A> const& ys) -> std::vector<T, A> {
+  auto u = std::vector<T, A>(xs.get_allocator());
   u.reserve(xs.size() + ys.size());
   auto const xs_end = xs.end(), ys_end = ys.end();
   auto xs_it = xs.begin(), ys_it = ys.begin();
@@ -181,6 +184,142 @@ auto vectorset_union_noback(std::vector<T> const& xs,
   return u;
 }
 
+// The forms below skip the result container: the '_into' ones write the
+// union, in order for the sorted containers, to an output iterator, the
+// '_size' ones only count it and the '_inplace' ones add ys to xs.
+
+template<typename It1, typename It2, typename Out>
+auto sorted_union_into(It1 xs_it, It1 xs_end, It2 ys_it, It2 ys_end, Out out) -> Out {
+  while (xs_it != xs_end && ys_it != ys_end) {
+    if (*xs_it < *ys_it) {
+      *out++ = *xs_it++;
+    } else if (*ys_it < *xs_it) {
+      *out++ = *ys_it++;
+    } else {
+      *out++ = *xs_it++;
+      ++ys_it;
+    }
+  }
+  out = std::copy(xs_it, xs_end, out);
+  return std::copy(ys_it, ys_end, out);
+}
+
+template<typename It1, typename It2>
+auto sorted_union_size(It1 xs_it, It1 xs_end, It2 ys_it, It2 ys_end) -> size_t {
+  auto n = size_t{0};
+  while (xs_it != xs_end && ys_it != ys_end) {
+    if (*xs_it < *ys_it) {
+      ++xs_it;
+    } else if (*ys_it < *xs_it) {
+      ++ys_it;
+    } else {
+      ++xs_it;
+      ++ys_it;
+    }
+    ++n;
+  }
+  return n + size_t(std::distance(xs_it, xs_end)) + size_t(std::distance(ys_it, ys_end));
+}
+
+// Adds the sorted range [ys_first, ys_last) to the sorted sequence xs: xs
+// grows to the size of the union, then is merged from the back, so every
+// element moves at most once and no other buffer is needed.
+template<typename Seq, typename It>
+auto sorted_union_inplace(Seq& xs, It ys_first, It ys_last) -> void {
+  auto i = xs.size();
+  auto k = sorted_union_size(xs.begin(), xs.end(), ys_first, ys_last);
+  xs.resize(k);
+  // Once k meets i, the rest of ys is already in xs[0, i).
+  for (auto ys_it = ys_last; k != i;) {
+    auto const& y = *std::prev(ys_it);
+    if (i > 0 && y < xs[i - 1]) {
+      xs[--k] = std::move(xs[--i]);
+    } else {
+      if (i > 0 && !(xs[i - 1] < y)) xs[--k] = std::move(xs[--i]);
+      else xs[--k] = y;
+      --ys_it;
+    }
+  }
+}
+
+template<typename T, typename A, typename Out>
+auto stdset_union_into(std::set<T, std::less<T>, A> const& xs,
+                       std::set<T, std::less<T>, A> const& ys, Out out) -> Out {
+  return sorted_union_into(xs.begin(), xs.end(), ys.begin(), ys.end(), out);
+}
+
+template<typename T, typename A>
+auto stdset_union_size(std::set<T, std::less<T>, A> const& xs,
+                       std::set<T, std::less<T>, A> const& ys) -> size_t {
+  return sorted_union_size(xs.begin(), xs.end(), ys.begin(), ys.end());
+}
+
+// Each element of ys goes in with the element after the previous one as a
+// hint: when the hint is right, an insertion costs O(1) instead of O(log n).
+template<typename T, typename A>
+auto stdset_union_inplace(std::set<T, std::less<T>, A>& xs,
+                          std::set<T, std::less<T>, A> const& ys) -> void {
+  auto hint = xs.begin();
+  for (auto const& y : ys) hint = std::next(xs.insert(hint, y));
+}
+
+template<typename T, typename A, typename Out>
+auto flatset_union_into(boost::container::flat_set<T, std::less<T>, A> const& xs,
+                        boost::container::flat_set<T, std::less<T>, A> const& ys, Out out) -> Out {
+  return sorted_union_into(xs.begin(), xs.end(), ys.begin(), ys.end(), out);
+}
+
+template<typename T, typename A>
+auto flatset_union_size(boost::container::flat_set<T, std::less<T>, A> const& xs,
+                        boost::container::flat_set<T, std::less<T>, A> const& ys) -> size_t {
+  return sorted_union_size(xs.begin(), xs.end(), ys.begin(), ys.end());
+}
+
+template<typename T, typename A>
+auto flatset_union_inplace(boost::container::flat_set<T, std::less<T>, A>& xs,
+                           boost::container::flat_set<T, std::less<T>, A> const& ys) -> void {
+  auto seq = xs.extract_sequence();
+  sorted_union_inplace(seq, ys.begin(), ys.end());
+  xs.adopt_sequence(boost::container::ordered_unique_range, std::move(seq));
+}
+
+// The elements of xs, then those of ys missing from xs.
+template<typename T, typename H, typename E, typename A, typename Out>
+auto stduset_union_into(std::unordered_set<T, H, E, A> const& xs,
+                        std::unordered_set<T, H, E, A> const& ys, Out out) -> Out {
+  out = std::copy(xs.begin(), xs.end(), out);
+  for (auto const& y : ys) if (xs.find(y) == xs.end()) *out++ = y;
+  return out;
+}
+
+template<typename T, typename H, typename E, typename A>
+auto stduset_union_size(std::unordered_set<T, H, E, A> const& xs,
+                        std::unordered_set<T, H, E, A> const& ys) -> size_t {
+  if (xs.size() < ys.size())
+    return stduset_union_size(ys, xs);
+
+  auto n = xs.size();
+  for (auto const& y : ys) n += xs.find(y) == xs.end();
+  return n;
+}
+
+template<typename T, typename H, typename E, typename A>
+auto stduset_union_inplace(std::unordered_set<T, H, E, A>& xs,
+                           std::unordered_set<T, H, E, A> const& ys) -> void {
+  xs.reserve(xs.size() + ys.size());
+  xs.insert(ys.begin(), ys.end());
+}
+
+template<typename T, typename A, typename Out>
+auto vectorset_union_into(std::vector<T, A> const& xs, std::vector<T, A> const& ys, Out out) -> Out {
+  return sorted_union_into(xs.begin(), xs.end(), ys.begin(), ys.end(), out);
+}
+
+template<typename T, typename A>
+auto vectorset_union_inplace(std::vector<T, A>& xs, std::vector<T, A> const& ys) -> void {
+  sorted_union_inplace(xs, ys.begin(), ys.end());
+}
+
 } /* end namespace manti */
 
 #endif
@@ -2,6 +2,8 @@
 #define EXPR_BT_HH_
 
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <boost/variant.hpp>
 
 namespace bt {
@@ -25,46 +27,132 @@ using expr = boost::variant<
 class binary_op {
  public:
   binary_op(expr const& lhs, expr const& rhs) : m_lhs(lhs), m_rhs(rhs) { }
+  inline binary_op(expr&& lhs, expr&& rhs);
+  binary_op(binary_op const&) = default;
+  inline binary_op(binary_op&& other);
+  auto operator=(binary_op const&) -> binary_op& = default;
+  auto operator=(binary_op&&) -> binary_op& = default;
   auto left() const -> expr const& { return m_lhs; }
   auto right() const -> expr const& { return m_rhs; }
+  auto left() -> expr& { return m_lhs; }
+  auto right() -> expr& { return m_rhs; }
  private:
   expr m_lhs, m_rhs;
 };
 
 struct addition : public binary_op {
   addition(expr const& left, expr const &right) : binary_op(left, right) { }
+  addition(expr&& left, expr&& right) : binary_op(std::move(left), std::move(right)) { }
 };
 
 struct substraction : public binary_op {
   substraction(expr const& left, expr const &right) : binary_op(left, right) { }
+  substraction(expr&& left, expr&& right) : binary_op(std::move(left), std::move(right)) { }
 };
 
 struct multiplication : public binary_op {
   multiplication(expr const& left, expr const &right) : binary_op(left, right) { }
+  multiplication(expr&& left, expr&& right) : binary_op(std::move(left), std::move(right)) { }
 };
 
 struct division : public binary_op {
   division(expr const& left, expr const &right) : binary_op(left, right) { }
+  division(expr&& left, expr&& right) : binary_op(std::move(left), std::move(right)) { }
 };
 
-// Overload * and + to simplify creating expressions.
+// boost::recursive_wrapper's move constructor allocates a new node and
+// move-constructs it, so a member-wise move of binary_op would walk the whole
+// subtree. Move-assignment between two variants holding the same node type
+// only swaps heap pointers: 'shallow_move' relies on it to move 'from' into
+// 'to' in O(1), leaving a node with two leaves in 'from'. Whatever 'to' held
+// is destroyed, so it must not be a deep tree.
+inline auto shallow_move(expr& to, expr& from) -> void {
+  boost::apply_visitor([&](auto& t) {
+    using T = std::decay_t<decltype(t)>;
+    if constexpr (std::is_same_v<T, int64_t> || std::is_same_v<T, std::string>) {
+      to = std::move(t);
+    } else {
+      to = T{expr{}, expr{}};
+      to = std::move(from);
+    }
+  }, from);
+}
+
+inline binary_op::binary_op(expr&& lhs, expr&& rhs) {
+  shallow_move(m_lhs, lhs);
+  shallow_move(m_rhs, rhs);
+}
+
+inline binary_op::binary_op(binary_op&& other)
+  : binary_op(std::move(other.m_lhs), std::move(other.m_rhs)) { }
+
+// Overload * and + to simplify creating expressions. The overloads for
+// temporaries move the children into the new node instead of copying them.
 
 inline auto operator+(expr const& lhs, expr const& rhs) -> expr {
   return addition{lhs, rhs};
 }
 
+inline auto operator+(expr&& lhs, expr&& rhs) -> expr {
+  return addition{std::move(lhs), std::move(rhs)};
+}
+
+inline auto operator+(expr&& lhs, expr const& rhs) -> expr {
+  return std::move(lhs) + expr{rhs};
+}
+
+inline auto operator+(expr const& lhs, expr&& rhs) -> expr {
+  return expr{lhs} + std::move(rhs);
+}
+
 inline auto operator-(expr const& lhs, expr const& rhs) -> expr {
   return substraction{lhs, rhs};
 }
 
+inline auto operator-(expr&& lhs, expr&& rhs) -> expr {
+  return substraction{std::move(lhs), std::move(rhs)};
+}
+
+inline auto operator-(expr&& lhs, expr const& rhs) -> expr {
+  return std::move(lhs) - expr{rhs};
+}
+
+inline auto operator-(expr const& lhs, expr&& rhs) -> expr {
+  return expr{lhs} - std::move(rhs);
+}
+
 inline auto operator*(expr const& lhs, expr const& rhs) -> expr {
   return multiplication{lhs, rhs};
 }
 
+inline auto operator*(expr&& lhs, expr&& rhs) -> expr {
+  return multiplication{std::move(lhs), std::move(rhs)};
+}
+
+inline auto operator*(expr&& lhs, expr const& rhs) -> expr {
+  return std::move(lhs) * expr{rhs};
+}
+
+inline auto operator*(expr const& lhs, expr&& rhs) -> expr {
+  return expr{lhs} * std::move(rhs);
+}
+
 inline auto operator/(expr const& lhs, expr const& rhs) -> expr {
   return division{lhs, rhs};
 }
 
+inline auto operator/(expr&& lhs, expr&& rhs) -> expr {
+  return division{std::move(lhs), std::move(rhs)};
+}
+
+inline auto operator/(expr&& lhs, expr const& rhs) -> expr {
+  return std::move(lhs) / expr{rhs};
+}
+
+inline auto operator/(expr const& lhs, expr&& rhs) -> expr {
+  return expr{lhs} / std::move(rhs);
+}
+
 struct add_visit : public boost::static_visitor<expr> {
   auto operator()(int64_t lhs, int64_t rhs) const -> expr {
     return expr{lhs + rhs};
@@ -0,0 +1,203 @@
+#ifndef EXPR_BT_ITER_HH_
+#define EXPR_BT_ITER_HH_
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+#include <type_traits>
+#include "expr/bt.hh"
+
+// Explicit-stack versions of the recursive visitors in 'expr/bt.hh'.
+//
+// boost::recursive_wrapper makes this harder than for 'va': copying a node
+// walks the whole subtree, so subtrees are handed around with
+// bt::shallow_move and intermediate results are kept in a std::deque, which
+// never relocates its elements.
+namespace bt::iter {
+
+template<typename T>
+constexpr bool is_leaf = std::is_same_v<T, int64_t> || std::is_same_v<T, std::string>;
+
+inline auto is_node(expr const& e) -> bool {
+  return boost::apply_visitor([](auto const& t) {
+    return !is_leaf<std::decay_t<decltype(t)>>;
+  }, e);
+}
+
+// Releases the expression without recursing, leaving a leaf in 'e'.
+inline auto destroy(expr& e) -> void {
+  auto pending = std::deque<expr>(1);
+  shallow_move(pending.back(), e);
+  e = expr{};
+
+  while (!pending.empty()) {
+    auto l = expr{}, r = expr{};
+    boost::apply_visitor([&](auto& t) {
+      if constexpr (!is_leaf<std::decay_t<decltype(t)>>) {
+        shallow_move(l, t.left());
+        shallow_move(r, t.right());
+      }
+    }, pending.back());
+    pending.pop_back();
+
+    for (auto* c : {&l, &r}) {
+      if (is_node(*c)) {
+        pending.emplace_back();
+        shallow_move(pending.back(), *c);
+      }
+    }
+  }
+}
+
+// Post-order fold. 'f' is called as f(int64_t), f(std::string const&) on
+// leaves and as f(node const&, R left, R right) on the four binary nodes.
+// R should be cheap to move; use the functions below to build expressions.
+template<typename R, typename F>
+auto fold(expr const& e, F&& f) -> R {
+  struct frame { expr const* e; bool expanded; };
+  auto todo = std::vector<frame>{{&e, false}};
+  auto done = std::vector<R>{};
+
+  while (!todo.empty()) {
+    auto const fr = todo.back();
+    todo.pop_back();
+    boost::apply_visitor([&](auto const& t) {
+      using T = std::decay_t<decltype(t)>;
+      if constexpr (is_leaf<T>) {
+        done.push_back(f(t));
+      } else if (!fr.expanded) {
+        todo.push_back({fr.e, true});
+        todo.push_back({&t.right(), false});
+        todo.push_back({&t.left(), false});
+      } else {
+        auto r = std::move(done.back());
+        done.pop_back();
+        auto l = std::move(done.back());
+        done.pop_back();
+        done.push_back(f(t, std::move(l), std::move(r)));
+      }
+    }, *fr.e);
+  }
+  return std::move(done.back());
+}
+
+// Number of nodes and leaves in the expression.
+inline auto size(expr const& e) -> size_t {
+  return fold<size_t>(e, [](auto const&, auto... children) -> size_t {
+    return (1 + ... + children);
+  });
+}
+
+// Length of the longest path from the root to a leaf.
+inline auto depth(expr const& e) -> size_t {
+  return fold<size_t>(e, [](auto const&, auto... children) -> size_t {
+    return 1 + std::max({size_t{0}, children...});
+  });
+}
+
+namespace detail {
+
+// Writes the node T(l, r) into 'out', which must be a leaf.
+template<typename T>
+auto make_node(expr& out, expr& l, expr& r) -> void {
+  out = T{expr{}, expr{}};
+  auto& n = boost::get<T>(out);
+  shallow_move(n.left(), l);
+  shallow_move(n.right(), r);
+}
+
+// Post-order rebuild: leaf(t) returns the new leaf, node(t, out, l, r)
+// writes the new node into 'out' given its already rebuilt children.
+template<typename Leaf, typename Node>
+auto rebuild(expr const& e, Leaf&& leaf, Node&& node) -> expr {
+  struct frame { expr const* e; bool expanded; };
+  auto todo = std::vector<frame>{{&e, false}};
+  auto done = std::deque<expr>{};
+
+  while (!todo.empty()) {
+    auto const fr = todo.back();
+    todo.pop_back();
+    boost::apply_visitor([&](auto const& t) {
+      using T = std::decay_t<decltype(t)>;
+      if constexpr (is_leaf<T>) {
+        auto x = leaf(t);
+        done.emplace_back();
+        shallow_move(done.back(), x);
+      } else if (!fr.expanded) {
+        todo.push_back({fr.e, true});
+        todo.push_back({&t.right(), false});
+        todo.push_back({&t.left(), false});
+      } else {
+        auto l = expr{}, r = expr{};
+        shallow_move(r, done.back());
+        done.pop_back();
+        shallow_move(l, done.back());
+        done.pop_back();
+        done.emplace_back();
+        node(t, done.back(), l, r);
+        destroy(l);
+        destroy(r);
+      }
+    }, *fr.e);
+  }
+
+  auto result = expr{};
+  shallow_move(result, done.back());
+  return result;
+}
+
+// One step of 'simplify' on a node whose children are already simplified.
+// Mirrors add_visit & co., moving subtrees instead of copying them.
+template<typename T>
+auto simplify_node(expr& out, expr& l, expr& r) -> void {
+  auto const* li = boost::get<int64_t>(&l);
+  auto const* ri = boost::get<int64_t>(&r);
+
+  if constexpr (std::is_same_v<T, addition>) {
+    if (li && ri) out = *li + *ri;
+    else if (li && *li == 0) shallow_move(out, r);
+    else if (ri && *ri == 0) shallow_move(out, l);
+    else make_node<T>(out, l, r);
+  } else if constexpr (std::is_same_v<T, substraction>) {
+    if (li && ri) out = *li - *ri;
+    else if (li && *li == 0) shallow_move(out, r);
+    else if (ri && *ri == 0) shallow_move(out, l);
+    else make_node<T>(out, l, r);
+  } else if constexpr (std::is_same_v<T, multiplication>) {
+    if (li && ri) out = *li * *ri;
+    else if ((li && *li == 0) || (ri && *ri == 0)) out = int64_t{0};
+    else if (li && *li == 1) shallow_move(out, r);
+    else if (ri && *ri == 1) shallow_move(out, l);
+    else if (ri) make_node<T>(out, r, l);
+    else make_node<T>(out, l, r);
+  } else {
+    if (li && ri) out = *li / *ri;
+    else if (li && *li == 0) out = int64_t{0};
+    else if (ri && *ri == 1) shallow_move(out, l);
+    else make_node<T>(out, l, r);
+  }
+}
+
+} /* end namespace detail */
+
+// Rebuilds the expression with every leaf replaced by f(leaf).
+template<typename F>
+auto map(expr const& e, F&& f) -> expr {
+  return detail::rebuild(e, f, [](auto const& t, expr& out, expr& l, expr& r) {
+    detail::make_node<std::decay_t<decltype(t)>>(out, l, r);
+  });
+}
+
+// Same result as boost::apply_visitor(bt::simplify{}, e).
+inline auto simplify(expr const& e) -> expr {
+  return detail::rebuild(e,
+    [](auto const& t) { return expr{t}; },
+    [](auto const& t, expr& out, expr& l, expr& r) {
+      detail::simplify_node<std::decay_t<decltype(t)>>(out, l, r);
+    });
+}
+
+} /* end namespace bt::iter */
+
+#endif
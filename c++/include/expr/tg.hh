@@ -0,0 +1,235 @@
+#ifndef EXPR_TG_HH_
+#define EXPR_TG_HH_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// A compact expression representation: every expression is a single 64-bit
+// word. The 3 low bits are a tag, the rest is either a small integer, the id
+// of an interned variable name or a pointer into an arena owned by a 'pool'.
+namespace tg {
+
+enum class tag : uint64_t {
+  integer = 0,
+  variable = 1,
+  boxed = 2,          // An integer too large to be stored inline.
+  addition = 3,
+  substraction = 4,
+  multiplication = 5,
+  division = 6
+};
+
+struct node;
+
+class expr {
+ public:
+  static constexpr uint64_t tag_bits = 3;
+  static constexpr uint64_t tag_mask = (1u << tag_bits) - 1;
+  static constexpr int64_t inline_min = -(int64_t{1} << (63 - tag_bits));
+  static constexpr int64_t inline_max = (int64_t{1} << (63 - tag_bits)) - 1;
+
+  constexpr expr() noexcept : m_bits(0) { }
+
+  static auto from_int(int64_t n) noexcept -> expr {
+    return expr{(static_cast<uint64_t>(n) << tag_bits) | uint64_t(tag::integer)};
+  }
+
+  static auto from_var(uint32_t id) noexcept -> expr {
+    return expr{(uint64_t{id} << tag_bits) | uint64_t(tag::variable)};
+  }
+
+  static auto from_ptr(void const* p, tag t) noexcept -> expr {
+    return expr{reinterpret_cast<uint64_t>(p) | uint64_t(t)};
+  }
+
+  auto kind() const noexcept -> tag { return static_cast<tag>(m_bits & tag_mask); }
+  auto is_int() const noexcept -> bool { return kind() == tag::integer || kind() == tag::boxed; }
+  auto is_var() const noexcept -> bool { return kind() == tag::variable; }
+  auto is_node() const noexcept -> bool { return kind() >= tag::addition; }
+
+  /** Value of an integer, inline or boxed. */
+  auto value() const noexcept -> int64_t {
+    return kind() == tag::integer?
+      static_cast<int64_t>(m_bits) >> tag_bits : *static_cast<int64_t const*>(ptr());
+  }
+
+  /** Interned id of a variable. */
+  auto var_id() const noexcept -> uint32_t { return static_cast<uint32_t>(m_bits >> tag_bits); }
+
+  /** Children of an operator. */
+  inline auto left() const noexcept -> expr;
+  inline auto right() const noexcept -> expr;
+
+  auto bits() const noexcept -> uint64_t { return m_bits; }
+
+ private:
+  constexpr explicit expr(uint64_t bits) noexcept : m_bits(bits) { }
+  auto ptr() const noexcept -> void const* { return reinterpret_cast<void const*>(m_bits & ~tag_mask); }
+
+  uint64_t m_bits;
+};
+
+struct node {
+  expr lhs, rhs;
+};
+
+inline auto expr::left() const noexcept -> expr { return static_cast<node const*>(ptr())->lhs; }
+inline auto expr::right() const noexcept -> expr { return static_cast<node const*>(ptr())->rhs; }
+
+/** Bump allocator for fixed-size objects; everything is freed with the arena. */
+template<typename T, size_t ChunkSize = 4096>
+class arena {
+ public:
+  template<typename... Args>
+  auto make(Args&&... args) -> T* {
+    if (m_chunks.empty() || m_used == ChunkSize) {
+      m_chunks.emplace_back(new T[ChunkSize]);
+      m_used = 0;
+    }
+    auto* p = &m_chunks.back()[m_used++];
+    *p = T{std::forward<Args>(args)...};
+    return p;
+  }
+
+  /** Number of objects allocated. */
+  auto size() const noexcept -> size_t {
+    return m_chunks.empty()? 0 : (m_chunks.size() - 1) * ChunkSize + m_used;
+  }
+
+  /** Bytes reserved by the arena. */
+  auto bytes() const noexcept -> size_t { return m_chunks.size() * ChunkSize * sizeof(T); }
+
+  /** Frees every object, keeping the first chunk for reuse. */
+  auto clear() -> void {
+    if (m_chunks.size() > 1) m_chunks.resize(1);
+    m_used = 0;
+  }
+
+ private:
+  std::vector<std::unique_ptr<T[]>> m_chunks;
+  size_t m_used = 0;
+};
+
+/** Owns the nodes, the boxed integers and the variable names of expressions. */
+class pool {
+ public:
+  auto num(int64_t n) -> expr {
+    if (n >= expr::inline_min && n <= expr::inline_max) return expr::from_int(n);
+    return expr::from_ptr(m_ints.make(n), tag::boxed);
+  }
+
+  auto var(std::string const& name) -> expr {
+    auto const it = m_ids.find(name);
+    if (it != m_ids.end()) return expr::from_var(it->second);
+    auto const id = static_cast<uint32_t>(m_names.size());
+    m_names.push_back(name);
+    m_ids.emplace(name, id);
+    return expr::from_var(id);
+  }
+
+  auto op(tag t, expr lhs, expr rhs) -> expr { return expr::from_ptr(m_nodes.make(lhs, rhs), t); }
+
+  auto add(expr lhs, expr rhs) -> expr { return op(tag::addition, lhs, rhs); }
+  auto sub(expr lhs, expr rhs) -> expr { return op(tag::substraction, lhs, rhs); }
+  auto mul(expr lhs, expr rhs) -> expr { return op(tag::multiplication, lhs, rhs); }
+  auto div(expr lhs, expr rhs) -> expr { return op(tag::division, lhs, rhs); }
+
+  /** Name of a variable. */
+  auto name(expr e) const -> std::string const& { return m_names[e.var_id()]; }
+
+  /** Number of operator nodes allocated. */
+  auto nodes() const noexcept -> size_t { return m_nodes.size(); }
+
+  /** Bytes reserved for nodes and boxed integers (names excluded). */
+  auto bytes() const noexcept -> size_t { return m_nodes.bytes() + m_ints.bytes(); }
+
+  /** Frees every expression built from this pool. Interned names are kept. */
+  auto clear() -> void { m_nodes.clear(); m_ints.clear(); }
+
+ private:
+  arena<node> m_nodes;
+  arena<int64_t, 512> m_ints;
+  std::vector<std::string> m_names;
+  std::unordered_map<std::string, uint32_t> m_ids;
+};
+
+// One step of 'simplify' on a node whose children are already simplified,
+// with the same rules as va::add_visit & co.
+inline auto simplify_node(pool& p, tag t, expr l, expr r) -> expr {
+  auto const li = l.is_int(), ri = r.is_int();
+  auto const lv = li? l.value() : 0, rv = ri? r.value() : 0;
+
+  switch (t) {
+    case tag::addition:
+      if (li && ri) return p.num(lv + rv);
+      if (li && lv == 0) return r;
+      if (ri && rv == 0) return l;
+      return p.add(l, r);
+    case tag::substraction:
+      if (li && ri) return p.num(lv - rv);
+      if (li && lv == 0) return r;
+      if (ri && rv == 0) return l;
+      return p.sub(l, r);
+    case tag::multiplication:
+      if (li && ri) return p.num(lv * rv);
+      if ((li && lv == 0) || (ri && rv == 0)) return p.num(0);
+      if (li && lv == 1) return r;
+      if (ri && rv == 1) return l;
+      return ri? p.mul(r, l) : p.mul(l, r);
+    default:
+      if (li && ri) return p.num(lv / rv);
+      if (li && lv == 0) return p.num(0);
+      if (ri && rv == 1) return l;
+      return p.div(l, r);
+  }
+}
+
+// Same result as va::simplify, with the new nodes allocated in 'p'. Uses an
+// explicit stack, so the depth of the expression is not limited.
+inline auto simplify(pool& p, expr e) -> expr {
+  struct frame { expr e; bool expanded; };
+  auto todo = std::vector<frame>{{e, false}};
+  auto done = std::vector<expr>{};
+
+  while (!todo.empty()) {
+    auto const fr = todo.back();
+    todo.pop_back();
+    if (!fr.e.is_node()) {
+      done.push_back(fr.e);
+    } else if (!fr.expanded) {
+      todo.push_back({fr.e, true});
+      todo.push_back({fr.e.right(), false});
+      todo.push_back({fr.e.left(), false});
+    } else {
+      auto const r = done.back();
+      done.pop_back();
+      auto const l = done.back();
+      done.pop_back();
+      done.push_back(simplify_node(p, fr.e.kind(), l, r));
+    }
+  }
+  return done.back();
+}
+
+// Number of nodes and leaves in the expression.
+inline auto size(expr e) -> size_t {
+  auto todo = std::vector<expr>{e};
+  auto n = size_t{0};
+  while (!todo.empty()) {
+    auto const x = todo.back();
+    todo.pop_back();
+    ++n;
+    if (x.is_node()) {
+      todo.push_back(x.right());
+      todo.push_back(x.left());
+    }
+  }
+  return n;
+}
+
+} /* end namespace tg */
+
+#endif
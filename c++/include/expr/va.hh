@@ -4,6 +4,7 @@
 #include <string>
 #include <variant>
 #include <memory>
+#include <utility>
 
 namespace va {
 
@@ -26,8 +27,11 @@ using expr = std::variant<
 class binary_op {
  public:
   binary_op(expr const& lhs, expr const& rhs) : m_lhs(lhs), m_rhs(rhs) { }
+  binary_op(expr&& lhs, expr&& rhs) : m_lhs(std::move(lhs)), m_rhs(std::move(rhs)) { }
   auto left() const -> expr const& { return m_lhs; }
   auto right() const -> expr const& { return m_rhs; }
+  auto left() -> expr& { return m_lhs; }
+  auto right() -> expr& { return m_rhs; }
  private:
   expr m_lhs, m_rhs;
 };
@@ -35,37 +39,92 @@ class binary_op {
 // Defines the 'addition' operator.
 struct addition : public binary_op {
   addition(expr const& left, expr const &right) : binary_op(left, right) { }
+  addition(expr&& left, expr&& right) : binary_op(std::move(left), std::move(right)) { }
 };
 
 // Defines the 'addition' operator.
 struct substraction : public binary_op {
   substraction(expr const& left, expr const &right) : binary_op(left, right) { }
+  substraction(expr&& left, expr&& right) : binary_op(std::move(left), std::move(right)) { }
 };
 
 // Defines the 'multiplication' operator.
 struct multiplication : public binary_op {
   multiplication(expr const& left, expr const &right) : binary_op(left, right) { }
+  multiplication(expr&& left, expr&& right) : binary_op(std::move(left), std::move(right)) { }
 };
 
 // Defines the 'multiplication' operator.
 struct division : public binary_op {
   division(expr const& left, expr const &right) : binary_op(left, right) { }
+  division(expr&& left, expr&& right) : binary_op(std::move(left), std::move(right)) { }
 };
 
+// The operators have overloads for temporaries: the children are then
+// moved into the new node instead of being copied.
+
 inline auto operator+(expr const& lhs, expr const& rhs) -> expr {
-  return std::make_shared<addition>(addition{lhs, rhs});
+  return std::make_shared<addition>(lhs, rhs);
+}
+
+inline auto operator+(expr&& lhs, expr&& rhs) -> expr {
+  return std::make_shared<addition>(std::move(lhs), std::move(rhs));
+}
+
+inline auto operator+(expr&& lhs, expr const& rhs) -> expr {
+  return std::move(lhs) + expr{rhs};
+}
+
+inline auto operator+(expr const& lhs, expr&& rhs) -> expr {
+  return expr{lhs} + std::move(rhs);
 }
 
 inline auto operator-(expr const& lhs, expr const& rhs) -> expr {
-  return std::make_shared<substraction>(substraction{lhs, rhs});
+  return std::make_shared<substraction>(lhs, rhs);
+}
+
+inline auto operator-(expr&& lhs, expr&& rhs) -> expr {
+  return std::make_shared<substraction>(std::move(lhs), std::move(rhs));
+}
+
+inline auto operator-(expr&& lhs, expr const& rhs) -> expr {
+  return std::move(lhs) - expr{rhs};
+}
+
+inline auto operator-(expr const& lhs, expr&& rhs) -> expr {
+  return expr{lhs} - std::move(rhs);
 }
 
 inline auto operator*(expr const& lhs, expr const& rhs) -> expr {
-  return std::make_shared<multiplication>(multiplication{lhs, rhs});
+  return std::make_shared<multiplication>(lhs, rhs);
+}
+
+inline auto operator*(expr&& lhs, expr&& rhs) -> expr {
+  return std::make_shared<multiplication>(std::move(lhs), std::move(rhs));
+}
+
+inline auto operator*(expr&& lhs, expr const& rhs) -> expr {
+  return std::move(lhs) * expr{rhs};
+}
+
+inline auto operator*(expr const& lhs, expr&& rhs) -> expr {
+  return expr{lhs} * std::move(rhs);
 }
 
 inline auto operator/(expr const& lhs, expr const& rhs) -> expr {
-  return std::make_shared<division>(division{lhs, rhs});
+  return std::make_shared<division>(lhs, rhs);
+}
+
+inline auto operator/(expr&& lhs, expr&& rhs) -> expr {
+  return std::make_shared<division>(std::move(lhs), std::move(rhs));
+}
+
+inline auto operator/(expr&& lhs, expr const& rhs) -> expr {
+  return std::move(lhs) / expr{rhs};
+}
+
+inline auto operator/(expr const& lhs, expr&& rhs) -> expr {
+  return expr{lhs} / std::move(rhs);
 }
 
 struct add_visit {
@@ -171,6 +230,12 @@ struct simplify1 {
     return std::visit(div_visit{}, d.left(), d.right());
   }
 
+  // The nodes are held through shared pointers.
+  template<typename T>
+  auto operator()(std::shared_ptr<T> const& p) const -> expr {
+    return (*this)(*p);
+  }
+
   template<typename T>
   auto operator()(T const& t) const -> expr {
     return expr{t};
@@ -206,6 +271,12 @@ struct simplify {
     return std::visit(simplify1{}, div_lr);
   }
 
+  // The nodes are held through shared pointers.
+  template<typename T>
+  auto operator()(std::shared_ptr<T> const& p) const -> expr {
+    return (*this)(*p);
+  }
+
   template<typename T>
   auto operator()(T const& t) const -> expr {
     return expr{t};
@@ -0,0 +1,253 @@
+#ifndef EXPR_VA_IO_HH_
+#define EXPR_VA_IO_HH_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "expr/va.hh"
+#include "expr/va_iter.hh"
+
+// Binary serialization of 'va::expr', so that simplified expressions can be
+// cached on disk.
+//
+// The stream is a 4-byte magic followed by the expression in postfix order.
+// Every record is a one-byte opcode and a payload: integers are zigzag
+// varints, variables a varint length and the bytes of the name, operators
+// have no payload and pop their two operands. The n-th operator record
+// defines node n; a node already written (a shared subtree) is emitted as a
+// 'backref' record holding its number instead of being written again. An
+// 'end' record holding the number of records before it closes the stream:
+// a postfix prefix can be a valid smaller expression, so a truncated stream
+// is only told apart by the missing end.
+namespace va::io {
+
+enum class op : uint8_t {
+  integer = 0,
+  variable = 1,
+  division = 2,
+  substraction = 3,
+  multiplication = 4,
+  addition = 5,
+  backref = 6,
+  end = 7
+};
+
+constexpr char magic[4] = {'V', 'A', 'E', '2'};
+
+namespace detail {
+
+inline auto put_varint(std::vector<uint8_t>& out, uint64_t n) -> void {
+  while (n >= 0x80) {
+    out.push_back(static_cast<uint8_t>(n) | 0x80);
+    n >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(n));
+}
+
+inline auto get_varint(uint8_t const*& p, uint8_t const* end) -> uint64_t {
+  auto n = uint64_t{0};
+  for (auto shift = 0u; shift < 64; shift += 7) {
+    if (p == end) throw std::runtime_error("va::io: truncated varint");
+    auto const b = *p++;
+    n |= uint64_t(b & 0x7f) << shift;
+    if (!(b & 0x80)) return n;
+  }
+  throw std::runtime_error("va::io: varint too long");
+}
+
+inline auto zigzag(int64_t n) -> uint64_t {
+  return (static_cast<uint64_t>(n) << 1) ^ static_cast<uint64_t>(n >> 63);
+}
+
+inline auto unzigzag(uint64_t n) -> int64_t {
+  return static_cast<int64_t>(n >> 1) ^ -static_cast<int64_t>(n & 1);
+}
+
+template<typename T>
+constexpr auto opcode() -> op {
+  if constexpr (std::is_same_v<T, division>) return op::division;
+  else if constexpr (std::is_same_v<T, substraction>) return op::substraction;
+  else if constexpr (std::is_same_v<T, multiplication>) return op::multiplication;
+  else return op::addition;
+}
+
+} /* end namespace detail */
+
+// Appends the encoding of 'e' to 'out'. Uses an explicit stack.
+inline auto write(expr const& e, std::vector<uint8_t>& out) -> void {
+  struct frame { expr const* e; bool expanded; };
+  auto todo = std::vector<frame>{{&e, false}};
+  auto ids = std::unordered_map<void const*, uint64_t>{};
+  auto records = uint64_t{0};
+
+  out.insert(out.end(), std::begin(magic), std::end(magic));
+  while (!todo.empty()) {
+    auto const fr = todo.back();
+    todo.pop_back();
+    std::visit([&](auto const& t) {
+      using T = std::decay_t<decltype(t)>;
+      if constexpr (std::is_same_v<T, int64_t>) {
+        out.push_back(uint8_t(op::integer));
+        ++records;
+        detail::put_varint(out, detail::zigzag(t));
+      } else if constexpr (std::is_same_v<T, std::string>) {
+        out.push_back(uint8_t(op::variable));
+        ++records;
+        detail::put_varint(out, t.size());
+        out.insert(out.end(), t.begin(), t.end());
+      } else if (!fr.expanded) {
+        auto const it = ids.find(t.get());
+        if (it != ids.end()) {
+          out.push_back(uint8_t(op::backref));
+          ++records;
+          detail::put_varint(out, it->second);
+          return;
+        }
+        todo.push_back({fr.e, true});
+        todo.push_back({&t->right(), false});
+        todo.push_back({&t->left(), false});
+      } else {
+        out.push_back(uint8_t(detail::opcode<typename T::element_type>()));
+        ++records;
+        ids.emplace(t.get(), ids.size());
+      }
+    }, *fr.e);
+  }
+  out.push_back(uint8_t(op::end));
+  detail::put_varint(out, records);
+}
+
+inline auto write(expr const& e) -> std::vector<uint8_t> {
+  auto out = std::vector<uint8_t>{};
+  write(e, out);
+  return out;
+}
+
+// Decodes an expression from [data, data + size), e.g. a mapped file. Shared
+// subtrees are shared again in the result. Throws std::runtime_error on
+// malformed input.
+inline auto read(uint8_t const* data, size_t size) -> expr {
+  auto const* p = data;
+  auto const* const end = data + size;
+  if (size < sizeof(magic) || std::memcmp(p, magic, sizeof(magic)) != 0)
+    throw std::runtime_error("va::io: bad magic");
+  p += sizeof(magic);
+
+  auto done = std::vector<expr>{};
+  auto nodes = std::vector<expr>{};
+  auto records = uint64_t{0};
+  try {
+    for (auto closed = false; !closed; ++records) {
+      if (p == end) throw std::runtime_error("va::io: truncated stream");
+      auto const code = static_cast<op>(*p++);
+      switch (code) {
+        case op::integer:
+          done.emplace_back(detail::unzigzag(detail::get_varint(p, end)));
+          break;
+        case op::variable: {
+          auto const n = detail::get_varint(p, end);
+          if (n > size_t(end - p)) throw std::runtime_error("va::io: truncated name");
+          done.emplace_back(std::string(reinterpret_cast<char const*>(p), n));
+          p += n;
+          break;
+        }
+        case op::backref: {
+          auto const id = detail::get_varint(p, end);
+          if (id >= nodes.size()) throw std::runtime_error("va::io: bad back-reference");
+          done.push_back(nodes[id]);
+          break;
+        }
+        case op::division:
+        case op::substraction:
+        case op::multiplication:
+        case op::addition: {
+          if (done.size() < 2) throw std::runtime_error("va::io: missing operand");
+          auto const r = std::move(done.back());
+          done.pop_back();
+          auto const l = std::move(done.back());
+          done.pop_back();
+          done.push_back(code == op::division? l / r :
+                         code == op::substraction? l - r :
+                         code == op::multiplication? l * r : l + r);
+          nodes.push_back(done.back());
+          break;
+        }
+        case op::end:
+          if (detail::get_varint(p, end) != records) throw std::runtime_error("va::io: bad record count");
+          if (p != end) throw std::runtime_error("va::io: trailing bytes");
+          closed = true;
+          break;
+        default:
+          throw std::runtime_error("va::io: bad opcode");
+      }
+    }
+    if (done.size() != 1) throw std::runtime_error("va::io: not a single expression");
+  } catch (...) {
+    // The partial results may be deep: release them without recursing.
+    nodes.clear();
+    for (auto& e : done) iter::destroy(e);
+    throw;
+  }
+  return std::move(done.back());
+}
+
+inline auto read(std::vector<uint8_t> const& bytes) -> expr {
+  return read(bytes.data(), bytes.size());
+}
+
+// Writes the encoding of 'e' to a file, through a temporary file renamed
+// over it once complete: a crash mid-write never leaves a partial cache.
+inline auto save(std::string const& path, expr const& e) -> void {
+  auto const bytes = write(e);
+  auto const tmp = path + ".tmp";
+  {
+    auto out = std::ofstream(tmp, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<char const*>(bytes.data()), bytes.size());
+    out.close();
+    if (!out) {
+      std::remove(tmp.c_str());
+      throw std::runtime_error("va::io: cannot write " + path);
+    }
+  }
+  if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+    std::remove(tmp.c_str());
+    throw std::runtime_error("va::io: cannot write " + path);
+  }
+}
+
+// Maps a file written by 'save' and decodes it.
+inline auto load(std::string const& path) -> expr {
+  auto const fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("va::io: cannot open " + path);
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    throw std::runtime_error("va::io: cannot read " + path);
+  }
+  auto const size = static_cast<size_t>(st.st_size);
+  auto* const addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) throw std::runtime_error("va::io: cannot map " + path);
+
+  struct unmap {
+    void* addr;
+    size_t size;
+    ~unmap() { ::munmap(addr, size); }
+  } const guard{addr, size};
+  return read(static_cast<uint8_t const*>(addr), size);
+}
+
+} /* end namespace va::io */
+
+#endif
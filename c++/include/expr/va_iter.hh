@@ -0,0 +1,138 @@
+#ifndef EXPR_VA_ITER_HH_
+#define EXPR_VA_ITER_HH_
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <utility>
+#include <variant>
+#include <type_traits>
+#include "expr/va.hh"
+
+// Explicit-stack versions of the recursive visitors in 'expr/va.hh'. They
+// never recurse on the depth of the expression, so they work on the left-deep
+// trees built by chains like 'e0 = e0 / 2'.
+namespace va::iter {
+
+template<typename T>
+constexpr bool is_leaf = std::is_same_v<T, int64_t> || std::is_same_v<T, std::string>;
+
+// Releases the expression without recursing: a node's children are moved
+// onto a stack before the node dies, but only when nobody else shares it.
+inline auto destroy(expr& e) -> void {
+  auto pending = std::vector<expr>{};
+  pending.push_back(std::exchange(e, expr{}));
+
+  while (!pending.empty()) {
+    auto x = std::move(pending.back());
+    pending.pop_back();
+    std::visit([&pending](auto& t) {
+      using T = std::decay_t<decltype(t)>;
+      if constexpr (!is_leaf<T>) {
+        if (t.use_count() == 1) {
+          pending.push_back(std::move(t->left()));
+          pending.push_back(std::move(t->right()));
+        }
+      }
+    }, x);
+  }
+}
+
+inline auto destroy(expr&& e) -> void {
+  destroy(e);
+}
+
+// Post-order fold. 'f' is called as f(int64_t), f(std::string const&) on
+// leaves and as f(node const&, R left, R right) on the four binary nodes.
+template<typename R, typename F>
+auto fold(expr const& e, F&& f) -> R {
+  struct frame { expr const* e; bool expanded; };
+  auto todo = std::vector<frame>{{&e, false}};
+  auto done = std::vector<R>{};
+
+  while (!todo.empty()) {
+    auto const fr = todo.back();
+    todo.pop_back();
+    std::visit([&](auto const& t) {
+      using T = std::decay_t<decltype(t)>;
+      if constexpr (is_leaf<T>) {
+        done.push_back(f(t));
+      } else if (!fr.expanded) {
+        todo.push_back({fr.e, true});
+        todo.push_back({&t->right(), false});
+        todo.push_back({&t->left(), false});
+      } else {
+        auto r = std::move(done.back());
+        done.pop_back();
+        auto l = std::move(done.back());
+        done.pop_back();
+        done.push_back(f(*t, std::move(l), std::move(r)));
+      }
+    }, *fr.e);
+  }
+  return std::move(done.back());
+}
+
+// Rebuilds the expression with every leaf replaced by f(leaf).
+template<typename F>
+auto map(expr const& e, F&& f) -> expr {
+  return fold<expr>(e, [&f](auto const& t, auto... children) -> expr {
+    using T = std::decay_t<decltype(t)>;
+    if constexpr (is_leaf<T>) {
+      return f(t);
+    } else {
+      return std::make_shared<T>(T{children...});
+    }
+  });
+}
+
+// Number of nodes and leaves in the expression.
+inline auto size(expr const& e) -> size_t {
+  return fold<size_t>(e, [](auto const&, auto... children) -> size_t {
+    return (1 + ... + children);
+  });
+}
+
+// Length of the longest path from the root to a leaf.
+inline auto depth(expr const& e) -> size_t {
+  return fold<size_t>(e, [](auto const&, auto... children) -> size_t {
+    return 1 + std::max({size_t{0}, children...});
+  });
+}
+
+// One step of 'simplify' on a node T whose children are already simplified.
+template<typename T>
+auto simplify_node(expr l, expr r) -> expr {
+  auto s = [&]() -> expr {
+    if constexpr (std::is_same_v<T, addition>)
+      return std::visit(add_visit{}, l, r);
+    else if constexpr (std::is_same_v<T, substraction>)
+      return std::visit(sub_visit{}, l, r);
+    else if constexpr (std::is_same_v<T, multiplication>)
+      return std::visit(mul_visit{}, l, r);
+    else
+      return std::visit(div_visit{}, l, r);
+  }();
+  auto result = std::visit(simplify1{}, s);
+  // Subtrees dropped by the rewrite (e.g. '0 * x') must not be freed recursively.
+  destroy(s);
+  destroy(l);
+  destroy(r);
+  return result;
+}
+
+// Same result as std::visit(va::simplify{}, e).
+inline auto simplify(expr const& e) -> expr {
+  return fold<expr>(e, [](auto const& t, auto... children) -> expr {
+    using T = std::decay_t<decltype(t)>;
+    if constexpr (is_leaf<T>) {
+      return expr{t};
+    } else {
+      return simplify_node<T>(std::move(children)...);
+    }
+  });
+}
+
+} /* end namespace va::iter */
+
+#endif
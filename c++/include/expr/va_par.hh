@@ -0,0 +1,95 @@
+#ifndef EXPR_VA_PAR_HH_
+#define EXPR_VA_PAR_HH_
+
+#include <deque>
+#include <unordered_set>
+#include <vector>
+#include "expr/va_iter.hh"
+#include "par/pool.hh"
+
+// Task-parallel 'simplify' for large expressions.
+//
+// A first, sequential pass measures the subtrees and marks the fork points:
+// the nodes whose two children both have at least 'cutoff' nodes. The
+// simplification then runs like va::iter::simplify, except that at a fork
+// point the right child is simplified by a separate task. Shared subtrees
+// are simplified once per path, as with the sequential versions, and the
+// result is the same expression whatever the number of threads.
+namespace va::par {
+
+inline auto fork_points(expr const& e, size_t cutoff) -> std::unordered_set<void const*> {
+  auto forks = std::unordered_set<void const*>{};
+  iter::fold<size_t>(e, [&forks, cutoff](auto const& t, auto... children) -> size_t {
+    if constexpr (sizeof...(children) == 0) {
+      return 1;
+    } else {
+      if (((children >= cutoff) && ...)) forks.insert(&t);
+      return (1 + ... + children);
+    }
+  });
+  return forks;
+}
+
+namespace detail {
+
+struct forked {
+  expr result;
+  ::par::task_group group;
+};
+
+inline auto simplify(::par::pool& pool, std::unordered_set<void const*> const& forks,
+                     expr const& e) -> expr {
+  struct frame { expr const* e; bool expanded; forked* right; };
+  auto todo = std::vector<frame>{{&e, false, nullptr}};
+  auto done = std::vector<expr>{};
+  auto tasks = std::deque<forked>{};
+
+  while (!todo.empty()) {
+    auto const fr = todo.back();
+    todo.pop_back();
+    std::visit([&](auto const& t) {
+      using T = std::decay_t<decltype(t)>;
+      if constexpr (iter::is_leaf<T>) {
+        done.push_back(expr{t});
+      } else if (!fr.expanded) {
+        if (forks.count(t.get())) {
+          auto& f = tasks.emplace_back();
+          auto const* right = &t->right();
+          pool.spawn(f.group, [&pool, &forks, &f, right] {
+            f.result = simplify(pool, forks, *right);
+          });
+          todo.push_back({fr.e, true, &f});
+        } else {
+          todo.push_back({fr.e, true, nullptr});
+          todo.push_back({&t->right(), false, nullptr});
+        }
+        todo.push_back({&t->left(), false, nullptr});
+      } else {
+        auto r = expr{};
+        if (fr.right) {
+          pool.wait(fr.right->group);
+          r = std::move(fr.right->result);
+        } else {
+          r = std::move(done.back());
+          done.pop_back();
+        }
+        auto l = std::move(done.back());
+        done.pop_back();
+        done.push_back(iter::simplify_node<typename T::element_type>(std::move(l), std::move(r)));
+      }
+    }, *fr.e);
+  }
+  return std::move(done.back());
+}
+
+} /* end namespace detail */
+
+// Same result as va::iter::simplify(e), computed by the threads of 'pool'.
+inline auto simplify(::par::pool& pool, expr const& e, size_t cutoff = 4096) -> expr {
+  auto const forks = fork_points(e, cutoff);
+  return detail::simplify(pool, forks, e);
+}
+
+} /* end namespace va::par */
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef PAR_POOL_HH_
+#define PAR_POOL_HH_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace par {
+
+/** Counts the tasks spawned in a group that have not finished yet. */
+class task_group {
+ public:
+  auto done() const noexcept -> bool { return m_pending.load(std::memory_order_acquire) == 0; }
+
+ private:
+  friend class pool;
+  std::atomic<size_t> m_pending{0};
+};
+
+/**
+ * A work-stealing thread pool. Each thread owns a queue: it pushes and pops
+ * its own tasks at the back and steals from the front of the others' queues.
+ * Threads that are not part of the pool share the first queue.
+ *
+ * 'wait' runs pending tasks until the group is done, so tasks can spawn and
+ * wait for subtasks without deadlocking. Tasks must not throw.
+ */
+class pool {
+ public:
+  /** A pool of 'nthreads' threads, counting the thread that calls 'wait'. */
+  explicit pool(size_t nthreads = std::thread::hardware_concurrency())
+    : m_queues(std::max<size_t>(nthreads, 1)) {
+    for (auto i = size_t{1}; i < m_queues.size(); ++i)
+      m_threads.emplace_back([this, i] { work(i); });
+  }
+
+  pool(pool const&) = delete;
+  auto operator=(pool const&) -> pool& = delete;
+
+  ~pool() {
+    {
+      std::lock_guard<std::mutex> lk(m_sleep);
+      m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& t : m_threads) t.join();
+  }
+
+  /** Number of threads, counting the caller. */
+  auto size() const noexcept -> size_t { return m_queues.size(); }
+
+  /** Queues f() as part of the group 'g'. */
+  template<typename F>
+  auto spawn(task_group& g, F&& f) -> void {
+    g.m_pending.fetch_add(1, std::memory_order_relaxed);
+    push([&g, f = std::forward<F>(f)]() mutable {
+      f();
+      g.m_pending.fetch_sub(1, std::memory_order_release);
+    });
+  }
+
+  /** Runs tasks until every task of the group has finished. */
+  auto wait(task_group& g) -> void {
+    while (!g.done())
+      if (!run_one(self())) std::this_thread::yield();
+  }
+
+ private:
+  struct queue {
+    std::mutex m;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  struct worker {
+    pool const* owner;
+    size_t index;
+  };
+
+  inline static thread_local worker t_worker{nullptr, 0};
+
+  auto self() const noexcept -> size_t { return t_worker.owner == this? t_worker.index : 0; }
+
+  auto push(std::function<void()> task) -> void {
+    auto& q = m_queues[self()];
+    {
+      std::lock_guard<std::mutex> lk(q.m);
+      q.tasks.push_back(std::move(task));
+    }
+    m_queued.fetch_add(1, std::memory_order_release);
+    { std::lock_guard<std::mutex> lk(m_sleep); }
+    m_wake.notify_one();
+  }
+
+  auto run_one(size_t i) -> bool {
+    auto task = std::function<void()>{};
+    auto const n = m_queues.size();
+    for (auto k = size_t{0}; k < n && !task; ++k) {
+      auto& q = m_queues[(i + k) % n];
+      std::lock_guard<std::mutex> lk(q.m);
+      if (q.tasks.empty()) continue;
+      if (k == 0) {
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+      } else {
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+      }
+    }
+    if (!task) return false;
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    return true;
+  }
+
+  auto work(size_t i) -> void {
+    t_worker = worker{this, i};
+    while (true) {
+      if (run_one(i)) continue;
+      std::unique_lock<std::mutex> lk(m_sleep);
+      m_wake.wait(lk, [this] { return m_stop || m_queued.load(std::memory_order_acquire) > 0; });
+      if (m_stop) return;
+    }
+  }
+
+  std::vector<queue> m_queues;
+  std::vector<std::thread> m_threads;
+  std::atomic<size_t> m_queued{0};
+  std::mutex m_sleep;
+  std::condition_variable m_wake;
+  bool m_stop = false;
+};
+
+} /* end namespace par */
+
+#endif